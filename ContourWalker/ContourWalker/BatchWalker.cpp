@@ -0,0 +1 @@
+#include "BatchWalker.h"
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "ParallelWalker.h"
+#include "LaneWalker.h"
+#include "WorkPool.h"
+
+//-------------------------------------------------------------------------------------------------
+// Walks a range of contours on a work stealing pool. Each contour is split into segments (as for
+// ParallelWalker, when there is an end x), each segment is walked a chunk at a time and every
+// chunk is a separate task, so a few expensive contours can't hold up the rest.
+//
+// Results from all the walkers go to one sink, which removes duplicates for each contour, prints
+// them and passes them to the results file writer. Throughput is reported at the end.
+//
+// Jobs that have got past native integers (so are on Int) are stepped in groups of up to 'lanes'
+// by a LaneWalker, a chunk of each per task. Groups are formed from the jobs waiting for one and
+// are small enough that every thread can have one, a smaller group only goes to a thread that
+// would otherwise have nothing to do.
+//
+// Int is the big integer type and Point the point template (ContourPointT or DeltaPointT).
+//-------------------------------------------------------------------------------------------------
+
+template <class Int, template <class> class Point>
+class BatchWalkerT
+{
+    struct Job
+    {
+        __int64 contour;
+        VLInt start_x;
+        VLInt end_x;
+        std::unique_ptr<TieredWalkerT<Int, Point>> walker;     // Created when the job first runs
+        __int64 rows{ 0 };          // Rows already counted
+    };
+
+    __int64 m_first;
+    __int64 m_last;
+    __int64 m_steps;
+    __int64 m_chunk;
+    WorkPool m_pool;
+    std::vector<std::unique_ptr<Job>> m_jobs;
+
+    // Lanes
+
+    typedef LaneWalkerT<Int, Point> LaneWalker;
+
+    size_t m_lane_count;                            // Most jobs in a group, 1 for no lanes
+    std::mutex m_lane_lock;
+    std::vector<Job*> m_waiting;                    // Jobs on Int waiting for a group
+    size_t m_laned{ 0 };                            // Jobs waiting or in a group
+    size_t m_solo{ 0 };                             // Unfinished jobs walking on their own
+    size_t m_groups{ 0 };                           // Groups pushed and not yet finished
+    std::vector<std::unique_ptr<LaneWalker>> m_lanes;   // One per worker
+
+    // The sink
+
+    std::mutex m_sink_lock;
+    ResultWriter& m_writer;
+    std::map<__int64, WalkingResults> m_results;    // By contour
+    std::map<__int64, int> m_running;               // Unfinished jobs, by contour
+    std::map<__int64, __int64> m_found;             // New results, by contour
+    __int64 m_result_count{ 0 };
+    std::atomic<__int64> m_rows{ 0 };
+
+public:
+
+    // With an end x the steps (chunks) are per segment, without one they are per contour. There
+    // are enough segments for about 4 tasks per thread. start_x = 0 for the usual starts. lanes
+    // is the most contours a thread walks at once, Int has to have a limit for more than 1.
+
+    BatchWalkerT(__int64 first, __int64 last, const VLInt & start_x, __int64 steps, __int64 chunk_size, const VLInt & end_x, int threads, int lanes = LaneWalker::LANES)
+        : m_first (first)
+        , m_last (last)
+        , m_steps (steps)
+        , m_chunk (chunk_size)
+        , m_pool (threads)
+        , m_lane_count ((Int::BITS == 0 || lanes < 1) ? 1 : (lanes < LaneWalker::LANES) ? lanes : LaneWalker::LANES)
+        , m_writer (ResultWriter::For("results.txt"))
+    {
+        auto count = last - first + 1;
+        auto segments = (int) std::min<__int64>(threads, (threads * 4 + count - 1) / count);
+
+        for (int i = 0; m_lane_count > 1 && i < threads; ++i)
+        {
+            m_lanes.emplace_back(new LaneWalker());
+        }
+
+        for (auto contour = first; contour <= last; ++contour)
+        {
+            auto starts = end_x.IsZero() ? std::vector<VLInt>{ start_x } : ParallelWalkerT<Int, Point>::Split(contour, start_x, end_x, segments);
+
+            m_results[contour].SetQuiet(true);
+            m_running[contour] = (int) starts.size();
+
+            for (size_t i = 0; i < starts.size(); ++i)
+            {
+                auto end = (i + 1 < starts.size()) ? starts[i + 1] - 1 : end_x;
+                auto job = new Job();
+
+                job->contour = contour;
+                job->start_x = starts[i];
+                job->end_x = end;
+                m_jobs.emplace_back(job);
+                ++m_solo;
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    void Walk()
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < m_jobs.size(); ++i)
+        {
+            auto job = m_jobs[i].get();
+
+            m_pool.Push((int) i, [this, job](int worker) { RunJob(job, worker); });
+        }
+
+        m_pool.Run();
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        auto seconds = elapsed.count();
+
+        std::cout << "Contours = " << m_first << ".." << m_last << ", tasks = " << m_jobs.size() << ", threads = " << m_pool.Threads() << ", steals = " << m_pool.Steals() << ", lanes = " << m_lane_count << " (" << CpuDispatch::Name(CpuDispatch::Level()) << ")" << std::endl;
+        std::cout << "Rows = " << m_rows << ", results = " << m_result_count << ", seconds = " << seconds;
+        if (seconds > 0) std::cout << ", rows per second = " << (__int64)(m_rows / seconds);
+        std::cout << std::endl;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    // One chunk of a job, pushes the next chunk back onto this worker's queue
+    void RunJob(Job * job, int worker)
+    {
+        if (! job->walker)
+        {
+            job->walker.reset(new TieredWalkerT<Int, Point>(job->contour, job->start_x, m_steps, m_chunk, job->end_x, true));
+        }
+
+        auto more = job->walker->Step();
+
+        Stepped(job, more);
+
+        if (! more)
+        {
+            job->walker.reset();
+        }
+
+        if (m_lane_count > 1 && (! more || job->walker->Big()))
+        {
+            // Finished, or on to a group
+
+            std::lock_guard<std::mutex> guard(m_lane_lock);
+
+            --m_solo;
+
+            if (more)
+            {
+                m_waiting.push_back(job);
+                ++m_laned;
+            }
+            Dispatch(worker);
+        }
+        else if (more)
+        {
+            m_pool.Push(worker, [this, job](int w) { RunJob(job, w); });
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // One chunk of each job in a group, in lanes if there is more than one. Jobs still on Int go
+    // back to wait for the next group.
+    void RunGroup(const std::vector<Job*> & group, int worker)
+    {
+        bool more[LaneWalker::LANES];
+
+        if (group.size() == 1)
+        {
+            more[0] = group[0]->walker->Step();
+        }
+        else
+        {
+            auto& lanes = *m_lanes[worker];
+
+            lanes.Clear();
+
+            for (auto job : group)
+            {
+                lanes.Add(job->walker->Big(), job->contour);
+            }
+
+            lanes.Step(more);
+
+            for (size_t i = 0; i < group.size(); ++i)
+            {
+                more[i] = group[i]->walker->BigStepped(more[i]);
+            }
+        }
+
+        for (size_t i = 0; i < group.size(); ++i)
+        {
+            Stepped(group[i], more[i]);
+        }
+
+        std::lock_guard<std::mutex> guard(m_lane_lock);
+
+        --m_groups;
+        m_laned -= group.size();
+
+        for (size_t i = 0; i < group.size(); ++i)
+        {
+            auto job = group[i];
+
+            if (! more[i])
+            {
+                job->walker.reset();
+            }
+            else if (job->walker->Big())
+            {
+                m_waiting.push_back(job);
+                ++m_laned;
+            }
+            else
+            {
+                ++m_solo;
+                m_pool.Push(worker, [this, job](int w) { RunJob(job, w); });
+            }
+        }
+
+        Dispatch(worker);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Pushes groups of the waiting jobs, lane lock held. Full groups are as big as they can be
+    // with a group for every thread, smaller ones only go if there is a thread with nothing to do.
+    // A solo job that joins the waiting jobs or finishes calls this again, so the last ones
+    // can't be left waiting.
+    void Dispatch(int worker)
+    {
+        auto threads = (size_t) m_pool.Threads();
+        auto size = std::min(m_lane_count, std::max<size_t>(1, (m_laned + m_solo) / threads));
+
+        while (m_waiting.size() >= size || (! m_waiting.empty() && m_groups + m_solo < threads))
+        {
+            auto take = std::min(size, m_waiting.size());
+            std::vector<Job*> group(m_waiting.end() - take, m_waiting.end());
+
+            m_waiting.resize(m_waiting.size() - take);
+            ++m_groups;
+            m_pool.Push(worker, [this, group](int w) { RunGroup(group, w); });
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // After a job has walked a chunk
+    void Stepped(Job * job, bool more)
+    {
+        auto rows = job->walker->Rows();
+
+        m_rows += rows - job->rows;
+        job->rows = rows;
+
+        Report(job, more);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Passes the job's new results to the sink, the walker has verified them
+    void Report(Job * job, bool more)
+    {
+        auto found = job->walker->TakeResults();
+        std::lock_guard<std::mutex> guard(m_sink_lock);
+        auto& results = m_results[job->contour];
+
+        for (auto& result : found)
+        {
+            if (results.Record(result))
+            {
+                ++m_result_count;
+                ++m_found[job->contour];
+                std::cout << "Contour " << job->contour << ", result " << m_result_count << ": " << result << std::endl;
+                m_writer.Write(result.ToString());
+            }
+        }
+
+        if (! more && --m_running[job->contour] == 0)
+        {
+            std::cout << "Contour " << job->contour << " finished, results = " << m_found[job->contour] << std::endl;
+            m_results.erase(job->contour);
+            m_found.erase(job->contour);
+        }
+    }
+};
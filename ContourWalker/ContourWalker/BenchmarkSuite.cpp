@@ -0,0 +1 @@
+#include "BenchmarkSuite.h"
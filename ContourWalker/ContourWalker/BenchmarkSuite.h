@@ -0,0 +1,319 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "VLUInt.h"
+#include "BigCube.h"
+#include "SubCube.h"
+#include "ContourPoint.h"
+#include "TieredWalker.h"
+#include "CpuDispatch.h"
+
+//-------------------------------------------------------------------------------------------------
+// The benchmarks every change is measured with, the same way each time. The micro benchmarks time
+// the pieces: VLUInt arithmetic at 1 to 15 limbs, the BigCube and SubCube increments, the
+// ContourPoint steps and Result::VerifySolution. The macro benchmarks walk contours 2, 20, 1000
+// and 1000000 for a fixed number of rows, quietly, as the threads of a batch do, through the
+// integer tiers the real walk would use.
+//
+// Each time is the best of a few runs, in ns per operation (or per row for the walks). They are
+// written as JSON, and compared with a baseline written the same way: anything more than the
+// threshold slower is a regression. benchmark_baseline.json has the last recorded numbers.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+class BenchmarkSuite
+{
+    struct Timing
+    {
+        std::string name;
+        std::function<double(int)> time;    // Seconds for a number of calls
+        double ops;                         // Operations per call
+        int reps;                           // Calls per run
+        double ns;                          // Per operation, the best run
+    };
+
+    static const int RUNS = 5;          // Each time is the best of these
+    static const int MAX_LIMBS = 15;
+    static constexpr double MIN_SECONDS = 0.02;     // For each run
+
+    std::vector<Timing> m_pending;      // Added but not yet timed
+    std::vector<Timing> m_timings;
+    unsigned __int64 m_sink{ 0 };       // So that nothing timed can be optimised away
+
+public:
+
+    //--------------------------------------------------------------------------------------------
+    // Runs everything, writes the times to output (if not empty) and compares them with baseline
+    // (if not empty). Returns the number of regressions.
+    inline static int Run(const std::string& output, const std::string& baseline, double threshold)
+    {
+        BenchmarkSuite suite;
+
+        std::cout << "Benchmark suite, ns per operation (per row for the walks), best of " << RUNS << " runs" << std::endl;
+
+        suite.Micro();
+        suite.Macro();
+
+        if (! output.empty())
+        {
+            suite.Save(output);
+            std::cout << "Written to " << output << std::endl;
+        }
+
+        return baseline.empty() ? 0 : suite.Compare(Load(baseline), threshold);
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    void Micro()
+    {
+        uint64_t seed = 88172645463325252ULL;
+        std::vector<VLUInt> a(MAX_LIMBS + 1);
+        std::vector<VLUInt> b(MAX_LIMBS + 1);
+        std::vector<VLUInt> product(MAX_LIMBS + 1);
+        std::vector<VLUInt> close(MAX_LIMBS + 1);
+        VLUInt r;
+
+        for (int n = 1; n <= MAX_LIMBS; ++n)
+        {
+            std::string limbs = "." + std::to_string(n);
+
+            a[n] = VLUInt::Random(n, seed);
+            b[n] = VLUInt::Random(n, seed);
+
+            if (a[n] < b[n])
+            {
+                std::swap(a[n], b[n]);
+            }
+
+            product[n] = a[n] * b[n] + VLUInt::Random(n, seed);
+            close[n] = a[n] + 1;        // Differs in the low limb, so compares all of them
+
+            Add("vluint.add" + limbs, [&, n]() { r = Opaque(a[n]) + b[n]; m_sink += r.IsZero(); });
+            Add("vluint.sub" + limbs, [&, n]() { r = Opaque(a[n]) - b[n]; m_sink += r.IsZero(); });
+            Add("vluint.mul" + limbs, [&, n]() { r = Opaque(a[n]) * b[n]; m_sink += r.IsZero(); });
+            Add("vluint.div" + limbs, [&, n]() { r = Opaque(product[n]) / b[n]; m_sink += r.IsZero(); });
+            Add("vluint.compare" + limbs, [&, n]() { m_sink += Opaque(a[n]) < close[n]; });
+            Add("vluint.copy" + limbs, [&, n]() { r = Opaque(a[n]); m_sink += r.IsZero(); });
+        }
+
+        // The walker's increments past native integers, a long way along contour 5
+
+        __int64 contour = 5;
+        VLInt x(10000000000000LL);
+        VLIntFixed fixed_x(x);
+        BigCubeT<VLIntFixed> cube(fixed_x);
+        SubCubeT<VLIntFixed> sub(fixed_x, VLIntFixed(contour));
+        auto point = ContourPointT<VLIntFixed>::SeekTo(contour, x);
+
+        Add("bigcube.increment", [&]() { ++cube; });
+        Add("subcube.increment", [&]() { ++sub; });
+        Add("contourpoint.increment_sub", [&]() { point.IncrementSub(); });
+        Add("contourpoint.increment_cube", [&]() { point.IncrementCube(); });
+
+        // The results of the start of contour 2
+
+        TieredWalkerT<VLIntFixed, ContourPointT> walker(2, VLInt(0), 10, 10000, VLInt(0), true);
+
+        walker.Walk();
+
+        auto& results = walker.Results().Found();
+
+        Add("result.verify", [&]() {
+            for (auto& result : results)
+            {
+                Opaque(result).VerifySolution();
+            }
+        }, (double)results.size());
+
+        Measure();
+
+        m_sink += cube.value.IsZero() + sub.value.IsZero() + point.Value().IsZero();
+    }
+    //--------------------------------------------------------------------------------------------
+    void Macro()
+    {
+        const __int64 chunks = 10;
+        const __int64 chunk_size = 200000;
+
+        for (__int64 contour : { 2LL, 20LL, 1000LL, 1000000LL })
+        {
+            Add("walk.contour_" + std::to_string(contour), [this, contour, chunks, chunk_size]() {
+                TieredWalkerT<VLIntFixed, ContourPointT> walker(contour, VLInt(0), chunks, chunk_size, VLInt(0), true);
+
+                walker.Walk();
+                m_sink += walker.Results().Found().size();
+            }, (double)(chunks * chunk_size));
+        }
+
+        Measure();
+    }
+    //--------------------------------------------------------------------------------------------
+    // number, by way of a pointer the optimiser can't see through, so that working it out can't
+    // be moved out of the timing loop
+    template <class T>
+    static const T& Opaque(const T& number)
+    {
+        const T * volatile hidden = &number;
+
+        return *hidden;
+    }
+    //--------------------------------------------------------------------------------------------
+    // A benchmark for Measure, fn does ops operations. The loop round it is built here, so the
+    // call isn't through the std::function.
+    template <class Fn>
+    void Add(const std::string& name, Fn fn, double ops = 1.0)
+    {
+        m_pending.push_back({ name, [fn](int reps) { return Time(reps, fn); }, ops, 1, 0 });
+    }
+    //--------------------------------------------------------------------------------------------
+    // Times the benchmarks added since the last call. Each one is called twice as many times until
+    // that takes long enough to time, which also warms up the caches. The runs go round all of
+    // them in turn, so that a slow patch of the machine's doesn't land on one benchmark's runs.
+    void Measure()
+    {
+        for (auto& timing : m_pending)
+        {
+            while (timing.time(timing.reps) < MIN_SECONDS && timing.reps < (1 << 24))
+            {
+                timing.reps *= 2;
+            }
+        }
+
+        for (int run = 0; run < RUNS; ++run)
+        {
+            for (auto& timing : m_pending)
+            {
+                auto ns = timing.time(timing.reps) * 1e9 / (timing.reps * timing.ops);
+
+                timing.ns = (run == 0 || ns < timing.ns) ? ns : timing.ns;
+            }
+        }
+
+        for (auto& timing : m_pending)
+        {
+            std::cout << "  " << std::setw(30) << std::left << timing.name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(12) << timing.ns << ((m_sink == 1) ? " " : "") << std::endl;
+            m_timings.push_back(timing);
+        }
+        std::cout.unsetf(std::ios_base::floatfield);
+
+        m_pending.clear();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Seconds for reps calls
+    template <class Fn>
+    static double Time(int reps, Fn fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < reps; ++i)
+        {
+            fn();
+        }
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    //--------------------------------------------------------------------------------------------
+    // One benchmark a line, which is all Load expects
+    void Save(const std::string& file_name) const
+    {
+        std::ofstream file(file_name);
+
+        if (! file)
+        {
+            throw std::runtime_error("Can't write " + file_name);
+        }
+
+        file << "{" << std::endl;
+        file << "  \"cpu\": \"" << CpuDispatch::Name(CpuDispatch::Level()) << "\"," << std::endl;
+        file << "  \"benchmarks\": [" << std::endl;
+
+        for (size_t i = 0; i < m_timings.size(); ++i)
+        {
+            file << "    {\"name\": \"" << m_timings[i].name << "\", \"ns\": " << std::fixed << std::setprecision(3)
+                 << m_timings[i].ns << "}" << ((i + 1 < m_timings.size()) ? "," : "") << std::endl;
+        }
+
+        file << "  ]" << std::endl;
+        file << "}" << std::endl;
+    }
+    //--------------------------------------------------------------------------------------------
+    // The times from a file written by Save, by name
+    static std::map<std::string, double> Load(const std::string& file_name)
+    {
+        std::ifstream file(file_name);
+        std::map<std::string, double> timings;
+        std::string line;
+        const std::string name_key = "{\"name\": \"";
+        const std::string ns_key = "\"ns\": ";
+
+        if (! file)
+        {
+            throw std::runtime_error("Can't read the baseline " + file_name);
+        }
+
+        while (std::getline(file, line))
+        {
+            auto name = line.find(name_key);
+            auto ns = line.find(ns_key);
+
+            if (name != std::string::npos && ns != std::string::npos)
+            {
+                name += name_key.size();
+                timings[line.substr(name, line.find('"', name) - name)] = atof(line.c_str() + ns + ns_key.size());
+            }
+        }
+
+        if (timings.empty())
+        {
+            throw std::runtime_error("No benchmarks in the baseline " + file_name);
+        }
+        return timings;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Lists the changes from the baseline, returns how many are more than threshold percent slower
+    int Compare(const std::map<std::string, double>& baseline, double threshold) const
+    {
+        int regressions = 0;
+
+        std::cout << "Compared with the baseline, regressions are over " << threshold << "% slower" << std::endl;
+
+        for (auto& timing : m_timings)
+        {
+            auto base = baseline.find(timing.name);
+
+            if (base == baseline.end() || base->second <= 0)
+            {
+                std::cout << "  " << std::setw(30) << std::left << timing.name << std::right << "  not in the baseline" << std::endl;
+                continue;
+            }
+
+            double change = (timing.ns / base->second - 1) * 100;
+            bool regression = change > threshold;
+
+            regressions += regression;
+
+            std::cout << "  " << std::setw(30) << std::left << timing.name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(12) << base->second << " ->" << std::setw(10) << timing.ns
+                      << std::setprecision(1) << std::setw(8) << std::showpos << change << "%" << std::noshowpos
+                      << (regression ? "  REGRESSION" : "") << std::endl;
+        }
+        std::cout.unsetf(std::ios_base::floatfield);
+
+        std::cout << regressions << " regression" << ((regressions == 1) ? "" : "s") << std::endl;
+
+        return regressions;
+    }
+};
@@ -1,48 +1,62 @@
 #pragma once
 
 #include "VLInt.h"
+#include "Checkpoint.h"
 
 //-------------------------------------------------------------------------------------------------
 // Implements a big cube using big integers
 // Implements increment and decrement operators using decrements to avoid big multiplications.
+// Int is the VLIntN width to use, BigCube is the full width version
 //
 // (c) John Whitehouse 2019 - 2022
 // www.eddaardvark.co.uk
 //-------------------------------------------------------------------------------------------------
 
 
-class BigCube
+template <class Int>
+class BigCubeT
 {
+    template <class> friend class BigCubeT;
+
     static const __int64 dddy = 6;   // 3rd derivative is constant
 
-    VLInt   ddy;
+    Int   ddy;
 
 public:
 
-    VLInt   root;
-    VLInt   value;
-    VLInt   dy;
+    Int   root;
+    Int   value;
+    Int   dy;
 
-    inline BigCube() {}
+    inline BigCubeT() {}
 
-    inline BigCube(const BigCube& other)
+    inline BigCubeT(const BigCubeT& other)
+        : ddy (other.ddy)
+        , root (other.root)
+        , value (other.value)
+        , dy (other.dy)
     {
-        BigCube ret;
-
-        root = other.root;
-        dy = other.dy;
-        ddy = other.ddy;
-        value = other.value;
     }
 
-    inline BigCube (__int64 n)
+    //-------------------------------------------------------------------------------------------------
+    // Convert from a different integer type
+    template <class Other>
+    inline explicit BigCubeT(const BigCubeT<Other>& other)
+        : ddy (other.ddy)
+        , root (other.root)
+        , value (other.value)
+        , dy (other.dy)
+    {
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline BigCubeT (__int64 n)
     {
-        root = VLInt (n);
+        root = Int (n);
 
         Inflate();
     }
     //-------------------------------------------------------------------------------------------------
-    inline BigCube (const VLInt& n)
+    inline BigCubeT (const Int& n)
     {
         root = n;
 
@@ -56,7 +70,7 @@ public:
         // y'' = 6xn + 6
         // y''' = 6;
 
-        auto n2 = root * root;
+        auto n2 = root.Square();
         auto n3 = n2 * root;
 
         value = n3;
@@ -64,12 +78,12 @@ public:
         ddy = (root + 1) * 6;
     }
     //-------------------------------------------------------------------------------------------------
-    inline VLInt GetIncrement() const
+    inline Int GetIncrement() const
     {
         return dy;
     }
     //-------------------------------------------------------------------------------------------------
-    inline VLInt GetDecrement() const
+    inline Int GetDecrement() const
     {
         auto temp_ddy = ddy - dddy;
         return dy - temp_ddy;
@@ -77,11 +91,11 @@ public:
     //-------------------------------------------------------------------------------------------------
     // Pre increment
     //-------------------------------------------------------------------------------------------------
-    inline BigCube& operator ++ ()
+    inline BigCubeT& operator ++ ()
     {
         ++root;
-        value = value + dy;
-        dy = dy + ddy;
+        value += dy;
+        dy += ddy;
         ddy = ddy + dddy;
 
         return (*this);
@@ -89,9 +103,9 @@ public:
     //--------------------------------------------------------------------------------------------
     // Post increment
     //--------------------------------------------------------------------------------------------
-    inline BigCube operator ++ (int)
+    inline BigCubeT operator ++ (int)
     {
-        BigCube temp = *this;
+        BigCubeT temp = *this;
 
         ++(*this);
         return temp;
@@ -99,64 +113,66 @@ public:
     //-------------------------------------------------------------------------------------------------
     // Pre decrement
     //-------------------------------------------------------------------------------------------------
-    inline BigCube& operator -- ()
+    inline BigCubeT& operator -- ()
     {
         ddy = ddy - dddy;
-        dy = dy - ddy;
-        value = value - dy;
+        dy -= ddy;
+        value -= dy;
         --root;
+
+        return (*this);
     }
     //--------------------------------------------------------------------------------------------
     // Post decrement
     //--------------------------------------------------------------------------------------------
-    inline BigCube operator -- (int)
+    inline BigCubeT operator -- (int)
     {
-        BigCube temp = *this;
+        BigCubeT temp = *this;
 
         --(*this);
         return temp;
     }
     //-------------------------------------------------------------------------------------------------
-    inline BigCube GetNext() const
+    inline BigCubeT GetNext() const
     {
-        BigCube ret = *this;
+        BigCubeT ret = *this;
 
         return ++ret;
     }
     //-------------------------------------------------------------------------------------------------
-    inline BigCube GetPrevious()
+    inline BigCubeT GetPrevious()
     {
-        BigCube ret;
+        BigCubeT ret;
 
         return --ret;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator > (const BigCube& other)
+    inline bool operator > (const BigCubeT& other)
     {
         return root > other.root;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator >= (const BigCube& other)
+    inline bool operator >= (const BigCubeT& other)
     {
         return root >= other.root;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator < (const BigCube& other)
+    inline bool operator < (const BigCubeT& other)
     {
         return root < other.root;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator <= (const BigCube& other)
+    inline bool operator <= (const BigCubeT& other)
     {
         return root < other.root;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator == (const BigCube& other)
+    inline bool operator == (const BigCubeT& other)
     {
         return root == other.root;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator != (const BigCube& other)
+    inline bool operator != (const BigCubeT& other)
     {
         return root == other.root;
     }
@@ -165,6 +181,24 @@ public:
     {
         return root.IsZero();
     }
+    //--------------------------------------------------------------------------------------------
+    // Checkpoints
+    //--------------------------------------------------------------------------------------------
+    inline void Save(std::ostream& os) const
+    {
+        Checkpoint::WriteInt(os, root);
+        Checkpoint::WriteInt(os, value);
+        Checkpoint::WriteInt(os, dy);
+        Checkpoint::WriteInt(os, ddy);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline void Load(std::istream& is)
+    {
+        root = Checkpoint::ReadInt<Int>(is);
+        value = Checkpoint::ReadInt<Int>(is);
+        dy = Checkpoint::ReadInt<Int>(is);
+        ddy = Checkpoint::ReadInt<Int>(is);
+    }
     //=========================================================================================================
     // Monitoring and Testing
     //=========================================================================================================
@@ -184,18 +218,18 @@ public:
         return sstrm.str();
     }
     //------------------------------------------------------------------------------------------------------
-    inline friend std::ostream& operator << (std::ostream& os, const BigCube& bc)
+    inline friend std::ostream& operator << (std::ostream& os, const BigCubeT& bc)
     {
         return os << bc.ToString();
     }
     //------------------------------------------------------------------------------------------------------
     inline static void Test()
     {
-        BigCube bc (1000000000);
+        BigCubeT bc (1000000000);
 
         bc.Verify("Test 1");
 
-        VLInt vli (1000000000);
+        Int vli (1000000000);
         auto vli3 = vli.Cube();
 
         if (vli3 != bc.value)
@@ -203,29 +237,29 @@ public:
             std::stringstream sstrm;
 
             sstrm << bc << " != " << vli3;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
-        VLInt eleven(11);
-        BigCube bc2(eleven);
+        Int eleven(11);
+        BigCubeT bc2(eleven);
 
         if (bc2.value != 1331)
         {
             std::stringstream sstrm;
 
             sstrm << "11^3 != 1331 , got " << bc2;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
-        VLInt m20(-20);
-        BigCube bc3(m20);
+        Int m20(-20);
+        BigCubeT bc3(m20);
 
         if (bc3.value != -8000)
         {
             std::stringstream sstrm;
 
             sstrm << "(-20)^3 != -8000 , got " << bc3;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
         // Finished
 
@@ -250,7 +284,7 @@ public:
             std::stringstream sstrm;
 
             sstrm << where << ": Value " << value << " != " << val << ", Detail = " << FullText();
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         if (t_dy != dy)
@@ -258,7 +292,7 @@ public:
             std::stringstream sstrm;
 
             sstrm << where << ": Dy " << dy << " != " << t_dy << ", Detail = " << FullText();
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         if (t_ddy != ddy)
@@ -266,10 +300,10 @@ public:
             std::stringstream sstrm;
 
             sstrm << where << ": Ddy " << ddy << " != " << t_ddy << ", Detail = " << FullText();
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
     }
 
 }; // class
 
-
+typedef BigCubeT<VLInt> BigCube;
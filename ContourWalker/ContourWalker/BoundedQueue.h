@@ -0,0 +1,212 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+//-------------------------------------------------------------------------------------------------
+// A fixed size lock free queue, any number of threads can push and pop. Each cell carries a
+// sequence number that says whether it is ready to be written (sequence == position) or read
+// (sequence == position + 1), so pushes and pops only contend on their own counter.
+//
+// The size must be a power of 2.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+template <class T>
+class BoundedQueue
+{
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    // The counters are a cache line away from each other and anything else, by padding rather
+    // than alignas as new doesn't have to honour an over-aligned type before C++17
+
+    static const size_t CACHE_LINE = 64;
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+
+    char m_pad_0[CACHE_LINE];
+    std::atomic<size_t> m_push{ 0 };
+    char m_pad_1[CACHE_LINE];
+    std::atomic<size_t> m_pop{ 0 };
+    char m_pad_2[CACHE_LINE];
+
+public:
+
+    BoundedQueue(size_t size)
+        : m_cells (new Cell[size])
+        , m_mask (size - 1)
+    {
+        if (size < 2 || (size & m_mask) != 0)
+        {
+            throw std::runtime_error("BoundedQueue size must be a power of 2");
+        }
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Returns false if the queue is full, value is only moved from if it succeeds
+    bool TryPush(T& value)
+    {
+        auto pos = m_push.load(std::memory_order_relaxed);
+        Cell * cell;
+
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+
+            auto seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = (intptr_t)seq - (intptr_t)pos;
+
+            if (diff == 0)
+            {
+                if (m_push.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_push.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Returns false if the queue is empty
+    bool TryPop(T& value)
+    {
+        auto pos = m_pop.load(std::memory_order_relaxed);
+        Cell * cell;
+
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+
+            auto seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+            if (diff == 0)
+            {
+                if (m_pop.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_pop.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->data);
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+    //=========================================================================================================
+    // Testing
+    //=========================================================================================================
+    // Several producers and one consumer through a small queue, everything arrives once
+    inline static void Test()
+    {
+        const int producers = 4;
+        const int count = 20000;
+
+        BoundedQueue<int> queue(64);
+        std::vector<std::thread> threads;
+
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&queue, p, count]()
+            {
+                for (int i = 1; i <= count; ++i)
+                {
+                    int value = p * count + i;
+
+                    while (! queue.TryPush(value))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        std::vector<int> seen(producers * count + 1, 0);
+        std::vector<int> last(producers, 0);
+        int received = 0;
+        std::string error;      // The first failure, thrown once the producers have finished
+
+        while (received < producers * count)
+        {
+            int value;
+
+            if (! queue.TryPop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Each producer's values arrive in order
+
+            int p = (value - 1) / count;
+
+            if ((value <= last[p] || ++seen[value] != 1) && error.empty())
+            {
+                std::stringstream sstrm;
+                sstrm << "BoundedQueue test: " << value << " out of order or repeated";
+                error = sstrm.str();
+            }
+
+            last[p] = value;
+            ++received;
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        if (! error.empty())
+        {
+            throw std::runtime_error(error.c_str());
+        }
+
+        int value;
+
+        if (queue.TryPop(value))
+        {
+            throw std::runtime_error("BoundedQueue test: queue not empty");
+        }
+
+        // Finished
+
+        std::cout << "BoundedQueue: All tests passed." << std::endl;
+    }
+};
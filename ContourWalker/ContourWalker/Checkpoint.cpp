@@ -0,0 +1 @@
+#include "Checkpoint.h"
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#include "VLInt.h"
+
+//-------------------------------------------------------------------------------------------------
+// Binary checkpoints of a walk. The file starts with a header that holds the command line settings
+// needed to carry on (Settings), followed by the walker state, which each class writes with its
+// own Save and reads back with Load.
+//
+// Integers are always written as VLInts, so a checkpoint taken on one integer type can be loaded
+// into another. Files are written to a temporary file which then replaces the old checkpoint, so
+// a crash part way through a save leaves the previous checkpoint intact.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+class Checkpoint
+{
+    static const uint32_t MAGIC = 0x50435743;   // "CWCP"
+    static const uint32_t VERSION = 2;          // 2: results are no longer saved
+
+public:
+
+    struct Settings
+    {
+        __int64 contour{ 0 };
+        __int64 steps{ 0 };
+        __int64 chunk_size{ 0 };
+        VLInt end_x;
+        bool delta{ false };
+    };
+
+    //--------------------------------------------------------------------------------------------
+    inline static std::string FileName()
+    {
+        return "checkpoint.bin";
+    }
+    //--------------------------------------------------------------------------------------------
+    template <class T>
+    inline static void Write(std::ostream& os, const T& value)
+    {
+        os.write((const char*)&value, sizeof(value));
+    }
+    //--------------------------------------------------------------------------------------------
+    template <class T>
+    inline static T Read(std::istream& is)
+    {
+        T value{};
+
+        is.read((char*)&value, sizeof(value));
+
+        if (! is)
+        {
+            throw std::invalid_argument("Checkpoint is truncated");
+        }
+        return value;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Any of the integer types, written as a VLInt
+    template <class Int>
+    inline static void WriteInt(std::ostream& os, const Int& value)
+    {
+        VLInt(value).Save(os);
+    }
+    //--------------------------------------------------------------------------------------------
+    template <class Int>
+    inline static Int ReadInt(std::istream& is)
+    {
+        return Int(VLInt::Load(is));
+    }
+    //--------------------------------------------------------------------------------------------
+    // Writes the settings and then whatever save writes, replacing the file in one step
+    template <class Saver>
+    static void Save(const std::string& file_name, const Settings& settings, Saver save)
+    {
+        auto temp_name = file_name + ".tmp";
+
+        {
+            std::ofstream file(temp_name, std::ios_base::binary | std::ios_base::trunc);
+
+            Write(file, (uint32_t) MAGIC);
+            Write(file, (uint32_t) VERSION);
+            Write(file, settings.contour);
+            Write(file, settings.steps);
+            Write(file, settings.chunk_size);
+            WriteInt(file, settings.end_x);
+            Write(file, settings.delta);
+
+            save(file);
+
+            file.flush();
+
+            if (! file)
+            {
+                throw std::runtime_error("Failed to write the checkpoint");
+            }
+        }
+
+        Replace(temp_name, file_name);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Opens a checkpoint and reads the settings, the walker state follows
+    static Settings Open(const std::string& file_name, std::ifstream& file)
+    {
+        file.open(file_name, std::ios_base::binary);
+
+        if (! file)
+        {
+            std::stringstream sstrm;
+            sstrm << "Can't open checkpoint " << file_name;
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+
+        if (Read<uint32_t>(file) != MAGIC || Read<uint32_t>(file) != VERSION)
+        {
+            std::stringstream sstrm;
+            sstrm << file_name << " is not a checkpoint";
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+
+        Settings settings;
+
+        settings.contour = Read<__int64>(file);
+        settings.steps = Read<__int64>(file);
+        settings.chunk_size = Read<__int64>(file);
+        settings.end_x = ReadInt<VLInt>(file);
+        settings.delta = Read<bool>(file);
+
+        return settings;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    // rename() replaces the target in one step on POSIX, Windows needs MoveFileEx to do the same
+    static void Replace(const std::string& from, const std::string& to)
+    {
+#ifdef _WIN32
+        auto ok = MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        auto ok = std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+        if (! ok)
+        {
+            std::stringstream sstrm;
+            sstrm << "Can't replace checkpoint " << to;
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+    }
+};
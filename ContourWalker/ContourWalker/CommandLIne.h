@@ -5,14 +5,37 @@
 #include <stdexcept>
 #include <iostream>
 #include <map>
+#include <thread>
+#include <algorithm>
+
+#include "VLInt.h"
+#include "Checkpoint.h"
 
 class CommandLine
 {
 	__int64 m_contour{ 1 };
+	__int64 m_last_contour{ 1 };	// Last of a batch (-c first..last)
 	__int64 m_iterations{ 0 };
 	__int64 m_chunk_size{ 500 };
+	int m_threads{ 1 };
+	int m_lanes{ 8 };				// Contours a thread walks at once in a batch
+	int m_checkpoint_seconds{ 0 };	// 0 for no checkpoints
+	int m_index_mb{ 64 };			// Memory limit of each set of results seen
+	bool m_bloom{ false };			// Bloom filter past it rather than forgetting
+	__int64 m_predict{ 0 };			// Rows to look ahead along each family, 0 for none
+	int m_metrics_seconds{ 0 };		// Between snapshots of the counters, 0 for none
+	std::string m_bench_file;		// Where the benchmark suite writes its times
+	std::string m_baseline_file;	// The times it compares them with
+	double m_threshold{ 10 };		// Percent slower than the baseline that counts as a regression
+	std::string m_trace_file;		// Where the trace goes, empty for no tracing
 	bool m_run_tests{false};
+	bool m_run_benchmark{false};
 	bool m_show_help{false};
+	bool m_delta{false};
+	bool m_resume{false};
+	VLInt m_start_x;				// 0 for the contour's usual start
+	VLInt m_end_x;
+	std::string m_cpu;				// Instruction set for the lanes, empty for the best there is
 
 	std::string m_exe;
 
@@ -22,6 +45,19 @@ class CommandLine
 		waiting_for_contour_value,
 		waiting_for_max_value,
 		waiting_for_chunk,
+		waiting_for_start_x,
+		waiting_for_end_x,
+		waiting_for_threads,
+		waiting_for_checkpoint,
+		waiting_for_lanes,
+		waiting_for_cpu,
+		waiting_for_index_mb,
+		waiting_for_predict,
+		waiting_for_metrics,
+		waiting_for_bench,
+		waiting_for_baseline,
+		waiting_for_threshold,
+		waiting_for_trace,
 	};
 
 	inline static std::string ToText(Mode m)
@@ -32,6 +68,19 @@ class CommandLine
 			{Mode::waiting_for_contour_value, "waiting_for_contour_value"},
 			{Mode::waiting_for_max_value, "waiting_for_max_value"},
 			{Mode::waiting_for_chunk, "waiting_for_chunk"},
+			{Mode::waiting_for_start_x, "waiting_for_start_x"},
+			{Mode::waiting_for_end_x, "waiting_for_end_x"},
+			{Mode::waiting_for_threads, "waiting_for_threads"},
+			{Mode::waiting_for_checkpoint, "waiting_for_checkpoint"},
+			{Mode::waiting_for_lanes, "waiting_for_lanes"},
+			{Mode::waiting_for_cpu, "waiting_for_cpu"},
+			{Mode::waiting_for_index_mb, "waiting_for_index_mb"},
+			{Mode::waiting_for_predict, "waiting_for_predict"},
+			{Mode::waiting_for_metrics, "waiting_for_metrics"},
+			{Mode::waiting_for_bench, "waiting_for_bench"},
+			{Mode::waiting_for_baseline, "waiting_for_baseline"},
+			{Mode::waiting_for_threshold, "waiting_for_threshold"},
+			{Mode::waiting_for_trace, "waiting_for_trace"},
 		};
 
 		auto it = names.find(m);
@@ -61,7 +110,7 @@ public:
 				{
 					std::stringstream sstrm;
 					sstrm << "Invalid argument: " << arg << std::endl;
-					throw std::exception (sstrm.str().c_str());
+					throw std::runtime_error(sstrm.str().c_str());
 				}
 				switch (arg[1])
 				{
@@ -69,35 +118,122 @@ public:
 					m_run_tests = true;
 					break;
 
+				case 'b':
+					m_run_benchmark = true;
+					break;
+
 				case 'c':
 					m = Mode::waiting_for_contour_value;
 					break;
 
+				case 'd':
+					m_delta = true;
+					break;
+
+				case 'f':
+					m = Mode::waiting_for_start_x;
+					break;
+
+				case 'k':
+					m = Mode::waiting_for_checkpoint;
+					break;
+
+				case 'l':
+					m = Mode::waiting_for_lanes;
+					break;
+
+				case 'm':
+					m = Mode::waiting_for_index_mb;
+					break;
+
 				case 'n':
 					m = Mode::waiting_for_max_value;
 					break;
 
+				case 'p':
+					m = Mode::waiting_for_threads;
+					break;
+
 				case 's':
 					m = Mode::waiting_for_chunk;
 					break;
 
+				case 'x':
+					m = Mode::waiting_for_end_x;
+					break;
+
 				case 'h':
 					m_show_help = true;
 					return;
+
+				case '-':
+					if (arg == "--cpu")
+					{
+						m = Mode::waiting_for_cpu;
+						break;
+					}
+					if (arg == "--predict")
+					{
+						m = Mode::waiting_for_predict;
+						break;
+					}
+					if (arg == "--bench")
+					{
+						m = Mode::waiting_for_bench;
+						break;
+					}
+					if (arg == "--baseline")
+					{
+						m = Mode::waiting_for_baseline;
+						break;
+					}
+					if (arg == "--threshold")
+					{
+						m = Mode::waiting_for_threshold;
+						break;
+					}
+					if (arg == "--trace")
+					{
+						m = Mode::waiting_for_trace;
+						break;
+					}
+					if (arg == "--metrics")
+					{
+						m = Mode::waiting_for_metrics;
+						break;
+					}
+					if (arg == "--bloom")
+					{
+						m_bloom = true;
+						break;
+					}
+					if (arg != "--resume")
+					{
+						std::stringstream sstrm;
+						sstrm << "Invalid argument: " << arg << std::endl;
+						throw std::runtime_error(sstrm.str().c_str());
+					}
+					m_resume = true;
+					break;
 				}
 				break;
 
 			case Mode::waiting_for_contour_value:
+			{
+				auto range = arg.find("..");
+
 				m_contour = atol(argv[i]);
+				m_last_contour = (range == std::string::npos) ? m_contour : atol(arg.c_str() + range + 2);
 				m = Mode::waiting_for_cmd;
 
-				if (m_contour <= 1)
+				if (m_contour <= 1 || m_last_contour < m_contour)
 				{
 					std::stringstream sstrm;
 					sstrm << "Invalid contour value: " << arg << std::endl;
-					throw std::exception(sstrm.str().c_str());
+					throw std::runtime_error(sstrm.str().c_str());
 				}
 				break;
+			}
 
 			case Mode::waiting_for_max_value:
 				m_iterations = atol(argv[i]);
@@ -107,7 +243,7 @@ public:
 				{
 					std::stringstream sstrm;
 					sstrm << "Invalid num steps value: " << arg << std::endl;
-					throw std::exception(sstrm.str().c_str());
+					throw std::runtime_error(sstrm.str().c_str());
 				}
 				break;
 
@@ -119,7 +255,139 @@ public:
 				{
 					std::stringstream sstrm;
 					sstrm << "Invalid chunk size: " << arg << std::endl;
-					throw std::exception(sstrm.str().c_str());
+					throw std::runtime_error(sstrm.str().c_str());
+				}
+				break;
+
+			case Mode::waiting_for_start_x:
+				m_start_x = VLInt::FromString(arg);
+				m = Mode::waiting_for_cmd;
+
+				if (!m_start_x.positive)
+				{
+					std::stringstream sstrm;
+					sstrm << "Invalid start x value: " << arg << std::endl;
+					throw std::runtime_error(sstrm.str().c_str());
+				}
+				break;
+
+			case Mode::waiting_for_end_x:
+				m_end_x = VLInt::FromString(arg);
+				m = Mode::waiting_for_cmd;
+
+				if (!m_end_x.positive)
+				{
+					std::stringstream sstrm;
+					sstrm << "Invalid end x value: " << arg << std::endl;
+					throw std::runtime_error(sstrm.str().c_str());
+				}
+				break;
+
+			case Mode::waiting_for_threads:
+				m_threads = atoi(argv[i]);
+				m = Mode::waiting_for_cmd;
+
+				if (m_threads < 0)
+				{
+					std::stringstream sstrm;
+					sstrm << "Invalid thread count: " << arg << std::endl;
+					throw std::runtime_error(sstrm.str().c_str());
+				}
+				if (m_threads == 0)
+				{
+					m_threads = std::max(1, (int)std::thread::hardware_concurrency());
+				}
+				break;
+
+			case Mode::waiting_for_checkpoint:
+				m_checkpoint_seconds = atoi(argv[i]);
+				m = Mode::waiting_for_cmd;
+
+				if (m_checkpoint_seconds < 0)
+				{
+					std::stringstream sstrm;
+					sstrm << "Invalid checkpoint interval: " << arg << std::endl;
+					throw std::runtime_error(sstrm.str().c_str());
+				}
+				break;
+
+			case Mode::waiting_for_lanes:
+				m_lanes = atoi(argv[i]);
+				m = Mode::waiting_for_cmd;
+
+				if (m_lanes < 1 || m_lanes > 8)
+				{
+					std::stringstream sstrm;
+					sstrm << "Invalid lane count: " << arg << std::endl;
+					throw std::runtime_error(sstrm.str().c_str());
+				}
+				break;
+
+			case Mode::waiting_for_cpu:
+				m_cpu = arg;
+				m = Mode::waiting_for_cmd;
+				break;
+
+			case Mode::waiting_for_index_mb:
+				m_index_mb = atoi(argv[i]);
+				m = Mode::waiting_for_cmd;
+
+				if (m_index_mb < 1)
+				{
+					std::stringstream sstrm;
+					sstrm << "Invalid memory limit: " << arg << std::endl;
+					throw std::runtime_error(sstrm.str().c_str());
+				}
+				break;
+
+			case Mode::waiting_for_predict:
+				m_predict = atoll(argv[i]);
+				m = Mode::waiting_for_cmd;
+
+				if (m_predict < 0 || m_predict > 1000000)
+				{
+					std::stringstream sstrm;
+					sstrm << "Invalid number of rows to predict: " << arg << std::endl;
+					throw std::runtime_error(sstrm.str().c_str());
+				}
+				break;
+
+			case Mode::waiting_for_metrics:
+				m_metrics_seconds = atoi(argv[i]);
+				m = Mode::waiting_for_cmd;
+
+				if (m_metrics_seconds < 1)
+				{
+					std::stringstream sstrm;
+					sstrm << "Invalid metrics interval: " << arg << std::endl;
+					throw std::runtime_error(sstrm.str().c_str());
+				}
+				break;
+
+			case Mode::waiting_for_bench:
+				m_bench_file = arg;
+				m = Mode::waiting_for_cmd;
+				break;
+
+			case Mode::waiting_for_baseline:
+				m_baseline_file = arg;
+				m = Mode::waiting_for_cmd;
+				break;
+
+			case Mode::waiting_for_trace:
+				m_trace_file = arg;
+				m = Mode::waiting_for_cmd;
+				break;
+
+			case Mode::waiting_for_threshold:
+				m_threshold = atof(argv[i]);
+				m = Mode::waiting_for_cmd;
+
+				if (m_threshold <= 0)
+				{
+					std::stringstream sstrm;
+					sstrm << "Invalid regression threshold: " << arg << std::endl;
+					throw std::runtime_error(sstrm.str().c_str());
 				}
 				break;
 			}
@@ -129,24 +397,97 @@ public:
 		{
 			std::stringstream sstrm;
 			sstrm << "Missing parameter: mode = " << ToText(m) << std::endl;
-			throw std::exception(sstrm.str().c_str());
+			throw std::runtime_error(sstrm.str().c_str());
+		}
+
+		if (IsBatch() && m_end_x.IsZero() && m_iterations == 0)
+		{
+			throw std::runtime_error("A batch of contours needs an end x (-x) or a number of chunks (-n)");
 		}
+
+		if (! IsBatch() && m_threads > 1 && m_end_x.IsZero())
+		{
+			throw std::runtime_error("Walking on more than one thread needs an end x (-x)");
+		}
+
+		if (! m_start_x.IsZero() && m_resume)
+		{
+			throw std::runtime_error("A start x (-f) can't be used with --resume");
+		}
+
+		if (! m_start_x.IsZero() && ! m_end_x.IsZero() && m_end_x < m_start_x)
+		{
+			throw std::runtime_error("The end x (-x) is before the start x (-f)");
+		}
+
+		if ((m_resume || m_checkpoint_seconds > 0) && (IsBatch() || m_threads > 1))
+		{
+			throw std::runtime_error("Checkpoints (-k, --resume) are only for a single contour on one thread");
+		}
+	}
+	//--------------------------------------------------------------------------------------------
+	// --resume takes the settings from the checkpoint rather than the command line
+	inline void ApplyCheckpoint(const Checkpoint::Settings& settings)
+	{
+		m_contour = settings.contour;
+		m_last_contour = settings.contour;
+		m_iterations = settings.steps;
+		m_chunk_size = settings.chunk_size;
+		m_end_x = settings.end_x;
+		m_delta = settings.delta;
 	}
 
 	inline bool RunTests() const { return m_run_tests; }
+	inline bool RunBenchmark() const { return m_run_benchmark; }
 	inline bool ShowHelp() const { return m_show_help; }
+	inline bool Delta() const { return m_delta; }
 	inline __int64 Contour() const { return m_contour; }
+	inline __int64 LastContour() const { return m_last_contour; }
+	inline bool IsBatch() const { return m_last_contour > m_contour; }
 	inline __int64 Iterations() const { return m_iterations; }
 	inline __int64 ChunkSize() const { return m_chunk_size; }
+	inline const VLInt& StartX() const { return m_start_x; }
+	inline const VLInt& EndX() const { return m_end_x; }
+	inline int Threads() const { return m_threads; }
+	inline int Lanes() const { return m_lanes; }
+	inline const std::string& Cpu() const { return m_cpu; }
+	inline size_t IndexBytes() const { return (size_t)m_index_mb << 20; }
+	inline bool Bloom() const { return m_bloom; }
+	inline __int64 Predict() const { return m_predict; }
+	inline int MetricsSeconds() const { return m_metrics_seconds; }
+	inline bool RunSuite() const { return ! m_bench_file.empty() || ! m_baseline_file.empty(); }
+	inline const std::string& BenchFile() const { return m_bench_file; }
+	inline const std::string& BaselineFile() const { return m_baseline_file; }
+	inline double Threshold() const { return m_threshold; }
+	inline const std::string& TraceFile() const { return m_trace_file; }
+	inline int CheckpointSeconds() const { return m_checkpoint_seconds; }
+	inline bool Resume() const { return m_resume; }
 
 	inline static void ShowOptions()
 	{
 		std::cout << "Command line options:" << std::endl;
-		std::cout << "  -c: <number> Set contour (must be 1 or more)" << std::endl;
+		std::cout << "  -b: Run the step and multiply benchmarks and exit" << std::endl;
+		std::cout << "  -c: <number> Set contour (must be 1 or more), or <first>..<last> to walk a batch of contours" << std::endl;
+		std::cout << "  -d: Only keep the differences, not the cubes (stays on native integers for longer)" << std::endl;
+		std::cout << "  -f: <number> Start at the row that crosses at or after this x, so that separate runs can walk windows -f to -x of a contour or batch" << std::endl;
 		std::cout << "  -h: Show this help" << std::endl;
+		std::cout << "  -k: <number> Save a checkpoint every this many seconds, and when interrupted (0 for none)" << std::endl;
+		std::cout << "  -l: <number> The most contours of a batch each thread walks at once, in lockstep, once past native integers (1 to 8, default 8)" << std::endl;
+		std::cout << "  -m: <number> Megabytes each contour's record of the results seen can use, past that it starts again (default 64)" << std::endl;
 		std::cout << "  -n: <number> The number of chunks to calculate (0 for run continuously)" << std::endl;
+		std::cout << "  -p: <number> Split the walk up to -x, or a batch, between this many threads (0 for one per core)" << std::endl;
 		std::cout << "  -s: <number> The number of steps in a chunk (must be 1 or more)" << std::endl;
 		std::cout << "  -t: Run tests" << std::endl;
+		std::cout << "  --baseline: <file> Run the benchmark suite and compare its times with those in this file (written by --bench), exits with 1 if any are slower by more than --threshold" << std::endl;
+		std::cout << "  --bench: <file> Run the benchmark suite (arithmetic, cube steps, result checks and walks of contours 2, 20, 1000 and 1000000) and write the times to this file as JSON" << std::endl;
+		std::cout << "  --bloom: Past -m, use a Bloom filter that remembers every result but may drop the odd new one as a repeat" << std::endl;
+		std::cout << "  --cpu: <generic|avx2|avx512> The instruction set for the lanes (-l), by default the best the CPU has" << std::endl;
+		std::cout << "  --metrics: <number> Every this many seconds, append a snapshot of the walk's counters (steps, hops, results, number sizes) to metrics.jsonl" << std::endl;
+		std::cout << "  --predict: <number> Once a family is found, look up to this many rows ahead (at most 1000000) along it for its results and go straight to them (single contour walks)" << std::endl;
+		std::cout << "  --resume: Carry on from the last checkpoint, the contour, -n, -s, -x and -d come from the checkpoint" << std::endl;
+		std::cout << "  --threshold: <number> The percentage slower than the --baseline that counts as a regression (default 10)" << std::endl;
+		std::cout << "  --trace: <file> Record where the time goes (chunks, batches of rows, result checks and writes, console output) and write it to this file at exit, as a Chrome trace for chrome://tracing or ui.perfetto.dev" << std::endl;
+		std::cout << "  -x: <number> Stop once x passes this value (0 for no limit), smaller limits use faster arithmetic" << std::endl;
 	}
 };
 
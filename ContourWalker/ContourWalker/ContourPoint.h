@@ -8,7 +8,8 @@
 //-------------------------------------------------------------------------------------------------
 // Implements a number of the form y^3 - 3nx^2 + 3n^2x + n^3, equivalent to (x+n)^3 - x^3
 //
-// Uses VLIntegers to avoid being confined to small numbers
+// Uses VLIntegers to avoid being confined to small numbers, Int is the VLIntN width to use,
+// ContourPoint is the full width version
 //
 // This is a single point on the contour in the map for X^3 + y^3 - z^3 = 0
 //
@@ -16,23 +17,26 @@
 // www.eddaardvark.co.uk
 //-------------------------------------------------------------------------------------------------
 
-class ContourPoint
+template <class Int>
+class ContourPointT
 {
+    template <class> friend class ContourPointT;
+
     //-------------------------------------------------------------------------------------------------
 
     static const __int64 target = 1025L;
 
-    BigCube cube;
+    BigCubeT<Int> cube;
 
 public:
 
-    SubCube subcube;
+    SubCubeT<Int> subcube;
 
-    VLInt value;
+    Int value;
 
-    inline ContourPoint() {}
+    inline ContourPointT() {}
 
-    inline ContourPoint(const ContourPoint & other)
+    inline ContourPointT(const ContourPointT & other)
         : cube (other.cube)
         , subcube (other.subcube)
         , value (other.value)
@@ -40,44 +44,136 @@ public:
         
     }
     //-------------------------------------------------------------------------------------------------
-    inline ContourPoint (__int64 contour)
+    // Convert from a different integer type
+    template <class Other>
+    inline explicit ContourPointT(const ContourPointT<Other> & other)
+        : cube (other.cube)
+        , subcube (other.subcube)
+        , value (other.value)
     {
-        static double factor = pow(2, 1.0 / 3.0) - 1;
-
-        auto x = VLInt((int)ceil(contour / factor));
-        auto y = VLInt(x);
-        auto n = VLInt(contour);
-        cube = BigCube(y);
-        subcube = SubCube(x, n);
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline ContourPointT (__int64 contour)
+    {
+        auto x = Int(StartX(contour));
+        auto y = Int(x);
+        auto n = Int(contour);
+        cube = BigCubeT<Int>(y);
+        subcube = SubCubeT<Int>(x, n);
         value = cube.value  - subcube.value;
     }
-    inline const VLInt& X() const { return subcube.x; }
-    inline const VLInt& Y() const { return cube.root; }
-    inline const VLInt& Value() const { return value; }
-    inline const bool IsPositive() const { return value.positive; }
     //-------------------------------------------------------------------------------------------------
-    inline ContourPoint GetNextX () const
+    // Where the walks start, the first x with 2x^3 >= (x + n)^3, which is n / (cbrt(2) - 1) rounded
+    // up. That's n(c^2 + c + 1) with c = cbrt(2), so sum the two cube roots rounded down and step
+    // on (at most twice) to the first x that passes.
+    inline static VLInt StartX(__int64 contour)
+    {
+        VLInt n(contour);
+        auto n3 = n.Cube();
+        auto x = n + (n3 * 4).ICbrt() + (n3 * 2).ICbrt();
+
+        while (x.Cube() * 2 < (x + n).Cube())
+        {
+            ++x;
+        }
+        return x;
+    }
+    //-------------------------------------------------------------------------------------------------
+    // The row a walk started at x begins on, so that a walk ending at x - 1 followed by one from x
+    // finds the same results as a single walk. That's the row after the first one whose crossing
+    // (its first point that isn't positive) is at or after x, y = ceil(cbrt((x - 1 + n)^3 - (x - 1)^3)).
+    // Returns the crossing and y.
+    //
+    // Along row y the crossing is where (x + n)^3 - x^3 = 3nx^2 + 3n^2x + n^3 reaches y^3, which
+    // is x = (sqrt(12ny^3 - 3n^4) - 3n^2) / 6n. The integer root puts it within a step of the answer.
+    inline static std::pair<VLInt, VLInt> SeekRow(__int64 contour, const VLInt & x)
+    {
+        VLInt n(contour);
+        auto last = x - 1;
+        auto y = ((last + n).Cube() - last.Cube() - 1).ICbrt() + 1;
+        auto y3 = y.Cube();
+        auto n2 = n.Square();
+        auto cross = ((n * y3 * 12 - n2.Square() * 3).IRoot(2) - n2 * 3) / (n * 6);
+
+        while ((cross + n).Cube() - cross.Cube() < y3)
+        {
+            ++cross;
+        }
+
+        while (cross > x && (cross - 1 + n).Cube() - (cross - 1).Cube() >= y3)
+        {
+            --cross;
+        }
+
+        return std::make_pair((cross < x) ? x : cross, y);
+    }
+    //-------------------------------------------------------------------------------------------------
+    // The point a walk started at x begins from, as FillNoDraw would have left it at the end of
+    // the row before: on the crossing and one row up. At or before the usual start this is the
+    // usual start.
+    inline static ContourPointT SeekTo(__int64 contour, const VLInt & x)
+    {
+        if (x <= StartX(contour))
+        {
+            return ContourPointT(contour);
+        }
+
+        auto row = SeekRow(contour, x);
+        ContourPointT ret(contour, row.first, row.second);
+
+        ret.IncrementCube();
+        return ret;
+    }
+    //-------------------------------------------------------------------------------------------------
+    // The point (x, y) on the contour
+    inline ContourPointT (__int64 contour, const VLInt & x, const VLInt & y)
+        : cube (Int(y))
+        , subcube (Int(x), Int(contour))
+    {
+        value = cube.value - subcube.value;
+    }
+    //-------------------------------------------------------------------------------------------------
+    // How far x can go with integers of this many bits, values are bounded by (x + n)^3. Half the
+    // bound, so that the row in progress when x passes it can't overflow. Returns 0 if they can't
+    // get started.
+
+    inline static VLInt MaxX(__int64 contour, int bits)
+    {
+        auto root = VLInt(2).Pow((bits - 4) / 3);
+        auto max_x = root / VLInt(2) - contour;
+
+        return (max_x > VLInt(contour) * 4) ? max_x : VLInt(0);
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline const Int& X() const { return subcube.x; }
+    inline const Int& Y() const { return cube.root; }
+    inline const Int& N() const { return subcube.n; }
+    inline const Int& Value() const { return value; }
+    inline const Int& DV() const { return subcube.dv; }
+    inline const bool IsPositive() const { return value.IsPositive(); }
+    //-------------------------------------------------------------------------------------------------
+    inline ContourPointT GetNextX () const
     {
         auto ret = (*this);
         ret.IncrementSub();
         return ret;
     }
     //-------------------------------------------------------------------------------------------------
-    inline ContourPoint GetNextY () const
+    inline ContourPointT GetNextY () const
     {
         auto ret = (*this);
         ret.IncrementCube();
         return ret;
     }
     //-------------------------------------------------------------------------------------------------
-    inline ContourPoint GetPreviousX () const
+    inline ContourPointT GetPreviousX () const
     {
         auto ret = (*this);
         ret.DecrementSub();
         return ret;
     }
     //-------------------------------------------------------------------------------------------------
-    inline ContourPoint GetPreviousY () const
+    inline ContourPointT GetPreviousY () const
     {
         auto ret = (*this);
         ret.DecrementCube();
@@ -87,24 +183,24 @@ public:
     inline void DecrementSub ()
     {
         -- subcube;
-        value = value + subcube.dv;
+        value += subcube.dv;
     }
     //----------------------------------------------------------------------------------------------------------------
     inline void IncrementSub ()
     {
-        value = value - subcube.dv; // Value = cube - sub, so subtract
+        value -= subcube.dv; // Value = cube - sub, so subtract
         ++ subcube;
     }
     //----------------------------------------------------------------------------------------------------------------
     inline void DecrementCube ()
     {
         -- cube;
-        value = value - cube.dy;
+        value -= cube.dy;
     }
     //----------------------------------------------------------------------------------------------------------------
     inline void IncrementCube ()
     {
-        value = value + cube.dy;
+        value += cube.dy;
         ++ cube;
     }
     //----------------------------------------------------------------------------------------------------------------
@@ -117,13 +213,41 @@ public:
     //--------------------------------------------------------------------------------------------
     inline Result GetResult() const
     {
-        return Result(subcube.x, cube.root, subcube.x + subcube.n, value);
+        return Result(VLInt(subcube.x), VLInt(cube.root), VLInt(subcube.x + subcube.n), VLInt(value));
     }
     //--------------------------------------------------------------------------------------------
     inline bool TestValue () const
     {
         return value.TestSmall(target);
     }
+    //--------------------------------------------------------------------------------------------
+    // The largest |value| that is a result, plus 1
+    inline static int Target()
+    {
+        return (int)target;
+    }
+    //--------------------------------------------------------------------------------------------
+    // TestValue for the point before this one along the row, without stepping back to it
+    inline bool TestPreviousX () const
+    {
+        return (value + subcube.PreviousDV()).TestSmall(target);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Checkpoints
+    //--------------------------------------------------------------------------------------------
+    inline void Save(std::ostream& os) const
+    {
+        cube.Save(os);
+        subcube.Save(os);
+        Checkpoint::WriteInt(os, value);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline void Load(std::istream& is)
+    {
+        cube.Load(is);
+        subcube.Load(is);
+        value = Checkpoint::ReadInt<Int>(is);
+    }
     //=========================================================================================================
     // Monitoring and Testing
     //=========================================================================================================
@@ -137,10 +261,11 @@ public:
 
     }
     //------------------------------------------------------------------------------------------------------
-    inline friend std::ostream& operator << (std::ostream& os, const ContourPoint& cp)
+    inline friend std::ostream& operator << (std::ostream& os, const ContourPointT& cp)
     {
         return os << cp.ToString();
     }
 
 }; // class
 
+typedef ContourPointT<VLInt> ContourPoint;
@@ -1,153 +1,683 @@
 #pragma once
 
-#include <fstream>
+#include <algorithm>
 
 #include "ContourPoint.h"
+#include "DeltaPoint.h"
 #include "WalkingResults.h"
 #include "CubicSpotter.h"
+#include "ResultWriter.h"
+#include "ResultPipeline.h"
+#include "Metrics.h"
+#include "Trace.h"
 
-class ContourWalker
+//-------------------------------------------------------------------------------------------------
+// Walks a contour, Int is the VLIntN width to use for the arithmetic, it must be wide enough for
+// the cube of the largest x visited (see RequiredLimbs). ContourWalker is the full width version.
+// Point is either ContourPointT or DeltaPointT, which only keeps the differences.
+//-------------------------------------------------------------------------------------------------
+
+template <class Int, class Point = ContourPointT<Int>>
+class ContourWalkerT
 {
+    template <class, class> friend class ContourWalkerT;
+    template <class, template <class> class> friend class LaneWalkerT;
+
     std::string m_result_file{ "results.txt" };
-    ContourPoint current;
+    ResultWriter * m_writer{ nullptr };     // The writer for m_result_file, found on first use
+    Point current;
     WalkingResults results;
-    VLUInt cross;
-    CubicSpotter spotter;
+    Int cross;
+    Int m_end_x;
+    CubicSpotterT<Int> spotter;
+    std::unique_ptr<ResultPipeline> m_pipeline;     // Records into results, so it is destroyed first
+    WalkCounters m_counters;
+    Metrics::Slot * m_slot{ nullptr };              // Where m_counters are published, found on first use
 
     __int64 hop{ 0 };
     __int64 hop_max{ 0 };
     __int64 m_steps{ 1 };
     __int64 m_chunk{ 500 };
+    __int64 m_chunk_index{ 0 };
+    __int64 m_row{ 0 };         // Position in the current chunk
+    __int64 m_predict{ 0 };     // Rows to look ahead along each new family, 0 for none
+    bool m_quiet{ false };      // Only collect the results, no printing or results file
+
+    static const int linear_steps = 4;  // Steps along a row before FillNoDraw gallops
+    static const __int64 batch_rows = 1 << 16;     // Rows walked between trace spans
 
 public:
 
-    ContourWalker(__int64 contour, __int64 steps, __int64 chunk_size)
-        : m_steps(steps)
-        , m_chunk(chunk_size)
-        , current (contour)
+    // end_x = 0 for no limit
+
+    ContourWalkerT(__int64 contour, __int64 steps, __int64 chunk_size, const VLInt & end_x = VLInt(0))
+        : current (contour)
+        , m_end_x (end_x)
+        , m_steps (steps)
+        , m_chunk (chunk_size)
+    {
+    }
+    //--------------------------------------------------------------------------------------------
+    // Starts part way along the contour, at the first row that crosses at or after start_x (0
+    // for the usual start). A walk ending at start_x - 1 followed by this one finds the same
+    // results as a single walk.
+
+    ContourWalkerT(__int64 contour, const VLInt & start_x, __int64 steps, __int64 chunk_size, const VLInt & end_x)
+        : current (Point::SeekTo(contour, start_x))
+        , m_end_x (end_x)
+        , m_steps (steps)
+        , m_chunk (chunk_size)
+    {
+    }
+    //--------------------------------------------------------------------------------------------
+    // Take over from a walker using a different integer type, carries on where it stopped
+    template <class Other, class OtherPoint>
+    ContourWalkerT(const ContourWalkerT<Other, OtherPoint> & other, const VLInt & end_x)
+        : m_result_file (other.m_result_file)
+        , current (other.current)
+        , results (other.Results())
+        , cross (other.cross)
+        , m_end_x (end_x)
+        , m_counters (other.m_counters)
+        , m_slot (other.m_slot)
+        , hop (other.hop)
+        , hop_max (other.hop_max)
+        , m_steps (other.m_steps)
+        , m_chunk (other.m_chunk)
+        , m_chunk_index (other.m_chunk_index)
+        , m_row (other.m_row)
+        , m_predict (other.m_predict)
+        , m_quiet (other.m_quiet)
+    {
+        spotter.SetDelta(other.spotter.Delta());
+        spotter.SetStats(other.spotter.GetStats());
+    }
+    //--------------------------------------------------------------------------------------------
+    // The fewest 32 bit limbs that can walk contour as far as end_x, by the same bound as MaxEndX.
+    // Returns 0 if there is no limit.
+
+    inline static int RequiredLimbs(__int64 contour, const VLInt & end_x)
     {
+        if (end_x.IsZero())
+        {
+            return 0;
+        }
+
+        int limbs = 1;
+
+        while (MaxEndX(contour, limbs * 32) < end_x.Abs())
+        {
+            ++limbs;
+        }
+        return limbs;
+    }
+    //--------------------------------------------------------------------------------------------
+    // The reverse of RequiredLimbs, how far integers with this many bits can walk the contour.
+    // Returns 0 if they can't get started.
+
+    inline static VLInt MaxEndX(__int64 contour, int bits)
+    {
+        return Point::MaxX(contour, bits);
     }
 
     //--------------------------------------------------------------------------------------------
     void Walk()
+    {
+        Start();
+        Continue();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Resets the walk state and writes the header, Step or Continue do the walking
+    void Start()
     {
         hop = 0;
         hop_max = 0;
-        cross = VLUInt(0);
+        cross = Int(0);
+        m_chunk_index = 0;
+        m_row = 0;
+
+        if (! m_quiet)
+        {
+            std::stringstream sstrm;
+            sstrm << "Contour starting with " << current;
+            Write(sstrm.str());
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Walks the remaining chunks, stops part way through a chunk if x passes the end x
+    void Continue()
+    {
+        while (Step())
+        {
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Walks one chunk, returns false once there is nothing left to walk or the run has been
+    // interrupted
+    bool Step()
+    {
+        if (! CanStep())
+        {
+            return false;
+        }
 
-        std::stringstream sstrm;
-        sstrm << "Contour starting with " << current;
-        Write(sstrm.str());
+        Trace::Span span("chunk");
 
-        for (__int64 i = 0 ; m_steps == 0 || i < m_steps ; ++i)
+        while (m_row < m_chunk && ! Finished())
         {
-            FillNoDraw(m_chunk);
-            std::cout << "Chunk " << i;
-            if (m_steps > 0) std::cout << ", of " << m_steps;
-            std::cout << ", x = " << current.subcube.x << std::endl;
+            Trace::Span rows("rows");
+
+            FillNoDraw(std::min(m_row + batch_rows, m_chunk));
         }
+
+        return EndChunk();
+    }
+    //--------------------------------------------------------------------------------------------
+    inline bool CanStep() const
+    {
+        return ChunksLeft() && ! Finished() && ! ResultWriter::Interrupted();
+    }
+    //--------------------------------------------------------------------------------------------
+    // After the rows of a chunk, returns false if they stopped short of the end of it
+    bool EndChunk()
+    {
+        Publish();
+
+        if (m_row < m_chunk)
+        {
+            return false;
+        }
+
+        if (! m_quiet)
+        {
+            Trace::Span span("console");
+
+            std::stringstream sstrm;
+
+            sstrm << "Chunk " << m_chunk_index;
+            if (m_steps > 0) sstrm << ", of " << m_steps;
+            sstrm << ", x = " << current.X() << "\n";
+            std::cout << sstrm.str() << std::flush;
+        }
+
+        m_row = 0;
+        ++m_chunk_index;
+
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Rows walked since Start, including those walked by a walker this one took over from
+    inline __int64 Rows() const
+    {
+        return m_chunk_index * m_chunk + m_row;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline bool ChunksLeft() const
+    {
+        return m_steps == 0 || m_chunk_index < m_steps;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline bool Finished() const
+    {
+        return ! m_end_x.IsZero() && current.X() > m_end_x;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline const Int& X() const
+    {
+        return current.X();
+    }
+    //--------------------------------------------------------------------------------------------
+    inline const WalkingResults& Results() const
+    {
+        Drain();
+        return results;
+    }
+    //--------------------------------------------------------------------------------------------
+    // The results found since the last call, a quiet walk keeps them until then
+    inline std::vector<Result> TakeResults()
+    {
+        Drain();
+        return results.Take();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Everything needed to carry on from the end of the last Step. The contour, steps, chunk size
+    // and end x are set by the constructor, so they aren't saved. Load replaces Start.
+    void Save(std::ostream& os) const
+    {
+        Drain();
+        current.Save(os);
+        Checkpoint::WriteInt(os, cross);
+        Checkpoint::Write(os, hop);
+        Checkpoint::Write(os, hop_max);
+        Checkpoint::Write(os, m_chunk_index);
+        Checkpoint::Write(os, m_row);
+        Checkpoint::Write(os, spotter.Delta());
+        results.Save(os);
+    }
+    //--------------------------------------------------------------------------------------------
+    void Load(std::istream& is)
+    {
+        current.Load(is);
+        cross = Checkpoint::ReadInt<Int>(is);
+        hop = Checkpoint::Read<__int64>(is);
+        hop_max = Checkpoint::Read<__int64>(is);
+        m_chunk_index = Checkpoint::Read<__int64>(is);
+        m_row = Checkpoint::Read<__int64>(is);
+        spotter.SetDelta(Checkpoint::Read<__int64>(is));
+        results.Load(is);
+    }
+    //--------------------------------------------------------------------------------------------
+    // A walk split in two, or saved part way and carried on by a new walker, finds the same
+    // results, in the same order, as a single walk. The limbs RequiredLimbs asks for are the
+    // fewest that MaxEndX says can get there.
+    inline static void Test()
+    {
+        __int64 contours[3] = { 2, 5, 20 };
+        __int64 splits[3] = { 123457, 765432, 3333333 };
+        VLInt end(5000000);
+
+        for (auto contour : contours)
+        {
+            for (auto x : { VLInt(1000), VLInt(5000000), VLInt(1099900000000LL), VLInt(10).Pow(30) })
+            {
+                auto limbs = RequiredLimbs(contour, x);
+
+                if (MaxEndX(contour, limbs * 32) < x || (limbs > 1 && MaxEndX(contour, (limbs - 1) * 32) >= x))
+                {
+                    std::stringstream sstrm;
+                    sstrm << "RequiredLimbs test: contour " << contour << " to x = " << x << " got " << limbs << " limbs";
+                    throw std::runtime_error(sstrm.str().c_str());
+                }
+            }
+        }
+
+        for (auto contour : contours)
+        {
+            ContourWalkerT whole(contour, 0, 1000, end);
+
+            whole.SetQuiet(true);
+            whole.Walk();
+
+            for (auto split : splits)
+            {
+                ContourWalkerT first(contour, 0, 1000, VLInt(split - 1));
+                ContourWalkerT second(contour, VLInt(split), 0, 1000, end);
+                WalkingResults both;
+
+                first.SetQuiet(true);
+                first.Walk();
+                second.SetQuiet(true);
+                second.Walk();
+                both.SetQuiet(true);
+                both.SetKeep(true);
+                both.Merge(first.Results());
+                both.Merge(second.Results());
+
+                auto& expected = whole.Results().Found();
+                auto& found = both.Found();
+                bool same = expected.size() == found.size();
+
+                for (size_t i = 0; same && i < found.size(); ++i)
+                {
+                    same = found[i].Key() == expected[i].Key();
+                }
+
+                if (! same)
+                {
+                    std::stringstream sstrm;
+                    sstrm << "Split test: contour " << contour << " split at " << split << " found " << found.size() << " results, expected " << expected.size();
+                    throw std::runtime_error(sstrm.str().c_str());
+                }
+            }
+
+            // SeekTo lands where stepping along the rows would
+
+            Point stepped(contour);
+
+            for (auto split : splits)
+            {
+                auto seek = Point::SeekTo(contour, VLInt(split));
+
+                while (VLInt(stepped.Y()) < VLInt(seek.Y()))
+                {
+                    while (stepped.IsPositive())
+                    {
+                        stepped.IncrementSub();
+                    }
+                    stepped.IncrementCube();
+                }
+
+                if (VLInt(stepped.X()) != VLInt(seek.X()) || VLInt(stepped.Value()) != VLInt(seek.Value()))
+                {
+                    std::stringstream sstrm;
+                    sstrm << "SeekTo test: contour " << contour << " x = " << split << " got " << seek << ", expected " << stepped;
+                    throw std::runtime_error(sstrm.str().c_str());
+                }
+            }
+
+            ContourWalkerT part(contour, 0, 1000, end);
+            ContourWalkerT resumed(contour, 0, 1000, end);
+            std::stringstream checkpoint;
+
+            part.SetQuiet(true);
+            part.Start();
+
+            for (int i = 0; i < 50; ++i)
+            {
+                part.Step();
+            }
+
+            part.Save(checkpoint);
+            resumed.SetQuiet(true);
+            resumed.Load(checkpoint);
+            resumed.Continue();
+
+            // The resumed walk only has the results from the checkpoint on
+
+            WalkingResults both;
+
+            both.SetQuiet(true);
+            both.SetKeep(true);
+            both.Merge(part.Results());
+            both.Merge(resumed.Results());
+
+            auto& expected = whole.Results().Found();
+            auto& found = both.Found();
+            bool same = expected.size() == found.size() && resumed.Rows() == whole.Rows();
+
+            for (size_t i = 0; same && i < found.size(); ++i)
+            {
+                same = found[i].Key() == expected[i].Key();
+            }
+
+            if (! same)
+            {
+                std::stringstream sstrm;
+                sstrm << "Checkpoint test: contour " << contour << " found " << found.size() << " results, expected " << expected.size();
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+        }
+
+        // Finished
+
+        std::cout << "ContourWalker: All tests passed." << std::endl;
+    }
+    //--------------------------------------------------------------------------------------------
+    // What the cubic spotter has seen, it only looks at walks that report their own results
+    inline const SpotterStats& Families() const
+    {
+        return spotter.GetStats();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Waits until the results found so far are recorded and queued for the results file
+    inline void Drain() const
+    {
+        if (m_pipeline)
+        {
+            m_pipeline->Drain();
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Look up to rows ahead along each family the spotter finds for its members (see Predict)
+    inline void SetPredict(__int64 rows)
+    {
+        m_predict = rows;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Used when several walkers share a contour, the owner reports their results
+    inline void SetQuiet(bool quiet)
+    {
+        m_quiet = quiet;
+        results.SetQuiet(quiet);
+        results.SetKeep(quiet);
     }
 
 protected:
 
+    //--------------------------------------------------------------------------------------------
     void FillNoDraw(__int64 width)
     {
-        for (auto x = 0 ; x < width ; ++x)
+        for ( ; m_row < width && ! Finished () ; ++m_row)
         {
             if (hop >= 2)
             {
                 current.HopSub(hop);
+                m_counters.Hop(hop);
                 hop = 0;
             }
 
-            auto prev = current;
             int count = 0;
 
-            while (current.IsPositive ())
+            // Step to the crossing, the first x where the value isn't positive. The hop usually
+            // leaves a few steps, longer runs gallop. Steps are taken in place, the last positive
+            // point (prev) is the one before current unless the row started on the crossing.
+
+            while (current.IsPositive () && count < linear_steps)
             {
                 ++count;
-                prev = current;
-                current = current.GetNextX();
+                current.IncrementSub();
             }
 
-            auto v2 = current.GetNextY();
+            m_counters.x_steps += count;
+            EndRow(count);
+        }
+    }
 
-            /*
-            if (hop_max > 3)
-            {
-                spotter.Add(v1.X(), v1.Value(), v2.Value());
-            }
+    //--------------------------------------------------------------------------------------------
+    // The rest of a row after the steps along it, count of them: the gallop if they didn't reach
+    // the crossing, the tests, the step up to the next row and the hop for it
+    void EndRow(int count)
+    {
+        if (current.IsPositive ())
+        {
+            current = Gallop(current, m_counters.x_steps);
+        }
+
+    // Check for crossing, positive to negative, at prev, current and the point above current
+
+        if (count > 0 ? current.TestPreviousX() : current.TestValue())
+        {
+            Found((count > 0) ? current.GetPreviousX().GetResult() : current.GetResult());
+        }
+        if (current.TestValue())
+        {
+            Found(current.GetResult());
+        }
+
+        // Families, from the values at the crossing and above it
+
+        bool spotting = hop_max > 3 && ! m_quiet;
+        Int below;
+
+        if (spotting)
+        {
+            below = current.Value();
+        }
+
+        current.IncrementCube();
+        ++m_counters.rows;
+
+        if (current.TestValue())
+        {
+            Found(current.GetResult());
+        }
+
+        if (spotting)
+        {
+            Spot(below);
+        }
 
-            int test = (prev.IsPositive() ? 4 : 0) + (current.IsPositive() ? 2 : 0) + (v2.IsPositive() ? 1 : 0);
+        auto delta = (cross.IsZero ()) ? cross : (current.X() - cross);
 
-            if (test != 5)
+        cross = current.X();
+
+        if (! delta.IsZero ())
+        {
+            __int64 d = delta.ToInt();
+
+            if (d > hop_max)
             {
-                std::cout << "Count: " << count << ", Test: " << test << ", P: " << prev << ", C: " << current << ", V2: " << v2 << std::endl;
+                if (d - hop_max > 1 && ! m_quiet)
+                {
+                    std::stringstream sstrm;
+
+                    sstrm << "Hop max = " << hop_max << ", delta = " << d << "\n";
+                    std::cout << sstrm.str() << std::flush;
+                }
+                spotter.SetDelta(d);
+                hop_max = d;
+                ++m_counters.hop_max_changes;
             }
-            */
+        }
+        hop = hop_max - 2;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Moves along the row from a positive point to the crossing, the first point that isn't
+    // positive. Doubles the jump while the value stays positive and then halves it back down. The
+    // sign only changes once along a row, so this lands on the same x as stepping all the way.
+    // Adds the points it tries to steps.
+
+    static Point Gallop(Point current, __int64& steps)
+    {
+        __int64 jump = 2;
+        bool galloping = true;
 
-        // Check for crossing, positive to negative
+        for (;;)
+        {
+            auto next = current;
+
+            ++steps;
 
-            if (prev.TestValue())
+            if (jump == 1)
+                next.IncrementSub();
+            else
+                next.HopSub(jump);
+
+            if (next.IsPositive())
             {
-                auto r = prev.GetResult();
-                results.Add(r);
-                Write(r);
+                current = next;
+                jump = galloping ? jump * 2 : (jump > 1) ? jump / 2 : 1;
             }
-            if (current.TestValue())
+            else if (jump == 1)
             {
-                auto r = current.GetResult();
-
-                results.Add(r);
-                Write(r);
+                return next;
             }
-            if (v2.TestValue())
+            else
             {
-                auto r = v2.GetResult();
-                results.Add(r);
-                Write(r);
+                galloping = false;
+                jump /= 2;
             }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Adds the crossing to the spotter, below is the value there, current the one above it
+    void Spot(const Int& below)
+    {
+        spotter.Add(current.X(), below, current.Value());
 
-            current = v2;
+        if (m_predict > 0 && spotter.NewFamily())
+        {
+            Predict();
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Looks ahead along a new family for its members, the points where its cubic is small, and
+    // checks each one by going straight to it. The families that stay on one row (all y1 or all
+    // y2) are points on a line, x going up by the stride and y by 1, so their cubic holds however
+    // far the line goes. The walk still visits every row, what it finds again is a repeat.
+    void Predict()
+    {
+        for (int series = 0; series < 2; ++series)
+        {
+            if ((spotter.Found() & (1 << (series * 4))) == 0)
+            {
+                continue;
+            }
+
+            auto members = spotter.SmallAhead(series, m_predict, ContourPoint::Target());
+
+            if (members.empty())
+            {
+                continue;
+            }
 
-            auto delta = (cross.IsZero ()) ? cross : (current.subcube.x.value - cross);
+            // current is a row above the newest point
 
-            cross = current.subcube.x.value;
+            auto contour = VLInt(current.N()).ToInt();
+            auto stride = VLInt(spotter.Stride());
+            auto x = VLInt(current.X());
+            auto y = VLInt(current.Y()) - 1 + series;
 
-            if (! delta.IsZero ())
+            for (auto j : members)
             {
-                __int64 d = delta.ToInt();
+                ContourPoint member(contour, x + stride * j, y + j);
+                bool confirmed = member.Value() == VLInt(spotter.Ahead(series, j));
+
+                spotter.Predicted(confirmed);
 
-                if (d > hop_max)
+                if (confirmed)
                 {
-                    if (d - hop_max > 1)
-                    {
-                        std::cout << "Hop max = " << hop_max << ", delta = " << d << std::endl;
-                    }
-                    spotter.SetDelta(d);
-                    hop_max = d;
+                    Found(member.GetResult());
                 }
             }
-            hop = hop_max - 2;
         }
     }
+    //--------------------------------------------------------------------------------------------
+    // A walker that reports its own results passes them to the pipeline, quiet ones are
+    // collected here for their owner
+    void Found(const Result& result)
+    {
+        ++m_counters.results;
+
+        if (m_quiet)
+        {
+            results.Add(result);
+            return;
+        }
+
+        if (! m_pipeline)
+        {
+            auto& writer = Writer();
 
-    void Write(const Result& result)
+            m_pipeline.reset(new ResultPipeline(results, [&writer](const Result& r) { writer.Write(r.ToString()); }));
+        }
+
+        m_pipeline->Push(result);
+    }
+
+    //--------------------------------------------------------------------------------------------
+    // Copies the counters to the metrics, if they are running, with the sizes of the numbers
+    // the walk has reached
+    void Publish()
     {
-        std::ofstream file;
+        if (m_slot == nullptr)
+        {
+            m_slot = Metrics::Register();
+
+            if (m_slot == nullptr)
+            {
+                return;
+            }
+        }
 
-        file.open(m_result_file, std::ios_base::app);
-        file << result << std::endl;
-        file.close();
+        m_counters.Sized();
+        m_counters.Limbs((VLInt(current.Value()).value.BitLength() + 31) / 32, (VLInt(current.DV()).value.BitLength() + 31) / 32);
+        m_slot->Publish(m_counters);
     }
 
     void Write(const std::string & text)
     {
-        std::ofstream file;
+        Writer().Write(text);
+    }
 
-        file.open(m_result_file, std::ios_base::app);
-        file << text << std::endl;
-        file.close();
+    ResultWriter& Writer()
+    {
+        if (m_writer == nullptr)
+        {
+            m_writer = &ResultWriter::For(m_result_file);
+        }
+        return *m_writer;
     }
 };
 
+typedef ContourWalkerT<VLInt> ContourWalker;
@@ -0,0 +1 @@
+#include "CpuDispatch.h"
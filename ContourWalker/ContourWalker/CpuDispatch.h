@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <stdexcept>
+
+#include "Platform.h"
+
+//-------------------------------------------------------------------------------------------------
+// Picks which build of the vectorised kernels runs, once, from what the CPU has. GCC and Clang on
+// x86 compile a kernel three times, for the baseline instruction set (generic), for AVX2 and for
+// AVX-512, by putting TARGET_AVX2 or TARGET_AVX512 on a copy of it that inlines the same body.
+// Elsewhere, and with MSVC (which builds for one /arch), the three are the same code and Level()
+// is always generic.
+//
+// Select forces a level, for timing one against another or checking they agree. It can't go
+// above what the CPU has.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_DISPATCH 1
+#define TARGET_AVX2 __attribute__((target("avx2,bmi2")))
+#ifdef __clang__
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512vl,avx512bw,avx512dq,bmi2")))
+#else
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512vl,avx512bw,avx512dq,bmi2,prefer-vector-width=512")))
+#endif
+#else
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
+class CpuDispatch
+{
+public:
+
+    enum Isa
+    {
+        GENERIC,
+        AVX2,
+        AVX512,
+    };
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    inline static std::atomic<int>& Current()
+    {
+        static std::atomic<int> level(Detect());
+
+        return level;
+    }
+
+public:
+
+    //--------------------------------------------------------------------------------------------
+    // The best level this CPU runs
+    inline static Isa Detect()
+    {
+#ifdef CPU_DISPATCH
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("bmi2"))
+        {
+            return AVX512;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2"))
+        {
+            return AVX2;
+        }
+#endif
+        return GENERIC;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline static Isa Level()
+    {
+        return (Isa)Current().load(std::memory_order_relaxed);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline static const char * Name(Isa isa)
+    {
+        switch (isa)
+        {
+        case AVX512:
+            return "avx512";
+        case AVX2:
+            return "avx2";
+        default:
+            return "generic";
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // name is one of the Names
+    inline static void Select(const std::string& name)
+    {
+        for (auto isa : { GENERIC, AVX2, AVX512 })
+        {
+            if (name == Name(isa))
+            {
+                if (isa > Detect())
+                {
+                    throw std::runtime_error("This CPU doesn't support " + name);
+                }
+
+                Current().store(isa);
+                return;
+            }
+        }
+
+        throw std::runtime_error("Unknown instruction set: " + name + " (generic, avx2 or avx512)");
+    }
+};
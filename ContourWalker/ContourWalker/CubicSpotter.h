@@ -1,160 +1,509 @@
 #pragma once
 
-#include <list>
-#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
 
 #include "VLInt.h"
 #include "FourPointCubic.h"
 
+//-------------------------------------------------------------------------------------------------
+// Looks for families along a contour: four crossings, equally spaced in x, whose values follow a
+// cubic in the step index with a leading coefficient of 1 (FourPointCubic::IsNatural). Each point
+// has two values, at the crossing (y1) and in the row above it (y2), and a family can use either
+// for each point as long as it only switches between them once, which makes 8 combinations.
+//
+// The spacing is the walker's hop delta or one less. The last CAPACITY points are kept in a ring,
+// each with the first and second differences of both values along the chain of points before it,
+// so a new point only needs a few subtractions and compares: a cubic is natural when its third
+// difference is 6, and a mixed combination's third difference is a pure one plus the y2 - y1
+// differences (e) of the points after the switch, -e1 + 3 e2 - 3 e3 + e4. Crossings are at least
+// 2 apart, so a point can only follow on from one earlier point, at one of the two spacings.
+//
+// Ahead and SmallAhead carry the all y1 and all y2 cubics on past the newest point, for the
+// walker to look for the rest of a family (ContourWalkerT::Predict).
+//
+// Int is the walker's integer type.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
 
-class CubicSpotter
+// How many of each a spotter has seen, carried over when a walker takes over from another
+
+struct SpotterStats
 {
-	class Point
-	{
-	public:
-		VLInt x, y1, y2;
-		
-		Point(const VLInt& vx, const VLInt& vy1, const VLInt& vy2) : x(vx), y1(vy1), y2(vy2) {}
-	};
+    __int64 points{ 0 };
+    __int64 natural{ 0 };       // Points that end a natural cubic
+    __int64 families{ 0 };      // Runs of them, with the same spacing and combination
+    __int64 predicted{ 0 };     // Family members looked for ahead of the walk (Predicted)
+    __int64 confirmed{ 0 };     // and found where the cubic said they would be
+};
+
+template <class Int>
+class CubicSpotterT
+{
+public:
+
+    static const int CAPACITY = 8;
+    static const int COMBINATIONS = 8;
+    static const __int64 NO_GAP = 0x4000000000000000;
+
+    typedef SpotterStats Stats;
+
+private:
+
+    // A chain of points spaced stride apart ending at this one, length points long
+
+    struct Chain
+    {
+        __int64 stride{ 0 };
+        int length{ 0 };
+        Int d1[2];                  // y - previous y, for y1 and y2
+        Int d2[2];
+        Int e1;                     // e of the previous point in the chain
+    };
 
-	__int64 delta{ -1 };
-	std::list <Point*> points;
+    struct Point
+    {
+        Int x;
+        Int y[2];
+        Int e;                      // y2 - y1
+        __int64 gap;                // x - the previous point's x
+        Chain chain;
+    };
+
+    Point m_ring[CAPACITY];
+    int m_count{ 0 };               // Points added, the newest is m_ring[(m_count - 1) % CAPACITY]
+    __int64 delta{ -1 };
+    Stats m_stats;
+
+    // The last natural cubic found, and the one before it for telling runs apart
+
+    int m_found{ 0 };               // Bit i for combination i
+    __int64 m_found_stride{ 0 };
+    int m_last_found{ 0 };
+    __int64 m_last_stride{ 0 };
 
 public:
 
-	~CubicSpotter()
-	{
-		while (!points.empty())
-		{
-			RemoveFirstPoint();
-		}
-	}
-
-	inline void SetDelta(__int64 d) { delta = d; }
-	inline __int64 Delta() const { return delta; }
-
-	void Add(const VLInt& vlx, const VLInt& y1, const VLInt& y2)
-	{
-		if (!points.empty())
-		{
-			auto del = (vlx - points.back()->x).ToInt();
-			if (del == 1)
-			{
-				std::cout << "Ignoring " << vlx << ", delta = " << del << std::endl;
-				return;
-			}
-		}
-		Point * pt = new Point (vlx, y1, y2);
-
-		points.emplace_back(pt);
-
-		TestSequence(delta-1);
-		TestSequence(delta);
-	}
-
-	void TestSequence(__int64 del)
-	{
-		if (points.size() >= 4)
-		{
-			std::cout << "Checking ";
-
-			for (const auto& it : points)
-				std::cout << it->x << ",";
-
-			std::cout << std::endl;
-
-			auto n = points.size();
-			Point* test[4];
-			int pos = 0;
-
-			for (const auto& pt : points)
-			{
-				if (pos == 0 || (pt->x - test[pos - 1]->x).ToInt() == del)
-				{
-					test[pos] = pt;
-					pos++;
-
-					if (pos == 4)
-					{
-						if (pos == 4)
-						{
-							TestCubic(*test[0], *test[1], *test[2], *test[3]);
-							std::cout << "Discarding x = " << points.front()->x << " (used)" << std::endl;
-							RemoveFirstPoint();
-							return;
-						}
-					}
-				}
-			}
-
-			if (n > 7)
-			{
-				std::cout << "Discarding x = " << points.front()->x << " (no match)" << std::endl;
-				RemoveFirstPoint();
-			}
-		}
-	}
-
-	void RemoveFirstPoint()
-	{
-		if (!points.empty())
-		{
-			delete points.front();
-			points.pop_front();
-		}
-	}
-
-	void TestCubic(const Point & p1, const Point& p2, const Point& p3, const Point& p4)
-	{
-		FourPointCubic c1(p1.y1, p2.y1, p3.y1, p4.y1);
-		FourPointCubic c2(p1.y1, p2.y1, p3.y1, p4.y2);
-		FourPointCubic c3(p1.y1, p2.y1, p3.y2, p4.y2);
-		FourPointCubic c4(p1.y1, p2.y2, p3.y2, p4.y2);
-		FourPointCubic c5(p1.y2, p2.y2, p3.y2, p4.y2);
-		FourPointCubic c6(p1.y2, p2.y2, p3.y2, p4.y1);
-		FourPointCubic c7(p1.y2, p2.y2, p3.y1, p4.y1);
-		FourPointCubic c8(p1.y2, p2.y1, p3.y1, p4.y1);
-
-		if (c1.IsNatural())
-		{
-			std::cout << "Row 0 = " << p1.y1 << ", " << p2.y1 << ", " << p3.y1 << ", " << p4.y1 << std::endl;
-			std::cout << "C1 = " << c1 << std::endl;
-		}
-		if (c2.IsNatural())
-		{
-			std::cout << "Row 0 = " << p1.y1 << ", " << p2.y1 << ", " << p3.y1 << ", " << p4.y2 << std::endl;
-			std::cout << "C2 = " << c2 << std::endl;
-		}
-		if (c3.IsNatural())
-		{
-			std::cout << "Row 0 = " << p1.y1 << ", " << p2.y1 << ", " << p3.y2 << ", " << p4.y2 << std::endl;
-			std::cout << "C3 = " << c3 << std::endl;
-		}
-		if (c4.IsNatural())
-		{
-			std::cout << "Row 0 = " << p1.y1 << ", " << p2.y2 << ", " << p3.y2 << ", " << p4.y2 << std::endl;
-			std::cout << "C4 = " << c4 << std::endl;
-		}
-		if (c5.IsNatural())
-		{
-			std::cout << "Row 0 = " << p1.y2 << ", " << p2.y2 << ", " << p3.y2 << ", " << p4.y2 << std::endl;
-			std::cout << "C5 = " << c5 << std::endl;
-		}
-		if (c6.IsNatural())
-		{
-			std::cout << "Row 0 = " << p1.y2 << ", " << p2.y2 << ", " << p3.y2 << ", " << p4.y1 << std::endl;
-			std::cout << "C6 = " << c6 << std::endl;
-		}
-		if (c7.IsNatural())
-		{
-			std::cout << "Row 0 = " << p1.y2 << ", " << p2.y2 << ", " << p3.y1 << ", " << p4.y1 << std::endl;
-			std::cout << "C7 = " << c7 << std::endl;
-		}
-		if (c8.IsNatural())
-		{
-			std::cout << "Row 0 = " << p1.y2 << ", " << p2.y1 << ", " << p3.y1 << ", " << p4.y1 << std::endl;
-			std::cout << "C8 = " << c8 << std::endl;
-		}
-	}
+    inline void SetDelta(__int64 d) { delta = d; }
+    inline __int64 Delta() const { return delta; }
+    inline const Stats& GetStats() const { return m_stats; }
+    inline void SetStats(const Stats& stats) { m_stats = stats; }
+    //--------------------------------------------------------------------------------------------
+    // Adds the crossing at x, returns a bit for each combination that ends a natural cubic here
+    int Add(const Int& x, const Int& y1, const Int& y2)
+    {
+        m_last_found = m_found;
+        m_last_stride = m_found_stride;
+        m_found = 0;
+
+        __int64 gap = (m_count > 0) ? (x - Newest().x).ToInt() : NO_GAP;
+
+        if (gap <= 1)
+        {
+            return 0;
+        }
+
+        auto& point = m_ring[m_count % CAPACITY];
+
+        point.x = x;
+        point.gap = gap;
+        point.y[0] = y1;
+        point.y[1] = y2;
+        point.e = y2 - y1;
+
+        Extend(point);
+
+        ++m_count;
+        ++m_stats.points;
+
+        if (m_found)
+        {
+            ++m_stats.natural;
+
+            if (m_found != m_last_found || m_found_stride != m_last_stride)
+            {
+                ++m_stats.families;
+            }
+        }
+        return m_found;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Counts a family member predicted from one of the cubics, and whether it was there
+    inline void Predicted(bool confirmed)
+    {
+        ++m_stats.predicted;
+        m_stats.confirmed += confirmed ? 1 : 0;
+    }
+    //--------------------------------------------------------------------------------------------
+    // The combinations the last Add found, bit i for combination i
+    inline int Found() const
+    {
+        return m_found;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Whether the last Add ended a natural cubic that the one before didn't, the start of a family
+    inline bool NewFamily() const
+    {
+        return m_found != 0 && (m_found != m_last_found || m_found_stride != m_last_stride);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline __int64 Stride() const
+    {
+        return m_found_stride;
+    }
+    //--------------------------------------------------------------------------------------------
+    // The x of the first point of the cubic found by the last Add
+    inline Int FirstX() const
+    {
+        return Newest().x - m_found_stride * 3;
+    }
+    //--------------------------------------------------------------------------------------------
+    // The cubic the last Add found, for the lowest combination found, with the first point at
+    // index 0. Returns false if its first points have left the ring.
+    bool Cubic(FourPointCubic& cubic) const
+    {
+        int combination = 0;
+
+        while (combination < COMBINATIONS && (m_found & (1 << combination)) == 0)
+        {
+            ++combination;
+        }
+        return Cubic(cubic, combination);
+    }
+    //--------------------------------------------------------------------------------------------
+    // The same for one combination, false if the last Add didn't find it
+    bool Cubic(FourPointCubic& cubic, int combination) const
+    {
+        if (combination >= COMBINATIONS || (m_found & (1 << combination)) == 0)
+        {
+            return false;
+        }
+
+        const Point * points[4];
+
+        for (int i = 0; i < 4; ++i)
+        {
+            points[i] = Find(Newest().x - m_found_stride * (3 - i));
+
+            if (points[i] == nullptr)
+            {
+                return false;
+            }
+        }
+
+        VLInt values[4];
+
+        for (int i = 0; i < 4; ++i)
+        {
+            values[i] = VLInt(points[i]->y[Series(combination, i)]);
+        }
+
+        cubic = FourPointCubic(values[0], values[1], values[2], values[3]);
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    // The value j steps on from the newest point along the last Add's all y1 (series 0) or all y2
+    // (series 1) cubic, from its differences there. Newton's backward difference formula, exact
+    // for a cubic: v + j d1 + j(j + 1) d2 / 2 + j(j + 1)(j + 2) d3 / 6, with d3 = 6.
+    inline Int Ahead(int series, __int64 j) const
+    {
+        auto& point = Newest();
+
+        return point.y[series] + point.chain.d1[series] * j + point.chain.d2[series] * (j * (j + 1) / 2) + Int(j * (j + 1) * (j + 2));
+    }
+    //--------------------------------------------------------------------------------------------
+    // The j from 1 to steps where Ahead is small, |value| < target, for a series the last Add
+    // found. Its steps, Ahead(j + 1) - Ahead(j), shrink while d2 + 6(j + 2) < 0 and then grow, so
+    // bisecting them finds where Ahead turns. Between the turns it only goes one way, so its small
+    // values there are a single run, found by bisecting for the start. steps is up to a million.
+    std::vector<__int64> SmallAhead(int series, __int64 steps, int target) const
+    {
+        auto& chain = Newest().chain;
+        auto step = [&](__int64 j) { return chain.d1[series] + chain.d2[series] * (j + 1) + Int(3 * (j + 1) * (j + 2)); };
+        Int zero(0);
+
+        // The first j that satisfies test, or end if none does, with test false then true
+
+        auto first = [](__int64 begin, __int64 end, auto test)
+        {
+            while (begin < end)
+            {
+                __int64 mid = begin + (end - begin) / 2;
+
+                if (test(mid))
+                    end = mid;
+                else
+                    begin = mid + 1;
+            }
+            return begin;
+        };
+
+        __int64 lowest = first(0, steps, [&](__int64 j) { return ! (chain.d2[series] + Int(6 * (j + 2)) < zero); });
+        __int64 down = first(0, lowest, [&](__int64 j) { return step(j) < zero; });
+        __int64 ends[4] = { 1, steps, steps, steps };
+        int pieces = 1;
+
+        if (down < lowest || step(lowest) < zero)
+        {
+            ends[1] = down;
+            ends[2] = first(lowest, steps, [&](__int64 j) { return ! (step(j) < zero); });
+            pieces = 3;
+        }
+
+        std::vector<__int64> ret;
+        Int low(-target);
+        Int high(target);
+
+        for (int i = 0; i < pieces; ++i)
+        {
+            __int64 lo = std::max(ends[i], (__int64)1);
+            __int64 hi = std::min(ends[i + 1], steps);
+
+            if (lo > hi)
+            {
+                continue;
+            }
+
+            bool rising = ! (Ahead(series, hi) < Ahead(series, lo));
+            __int64 j = first(lo, hi + 1, [&](__int64 j) { return rising ? low < Ahead(series, j) : Ahead(series, j) < high; });
+
+            for ( ; j <= hi && Ahead(series, j).TestSmall(target); ++j)
+            {
+                if (ret.empty() || j > ret.back())
+                {
+                    ret.push_back(j);
+                }
+            }
+        }
+        return ret;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Which value, 0 for y1 and 1 for y2, combination uses for point i (0 to 3). 0 is all y1, 1 to
+    // 3 switch to y2 for the last 1 to 3 points, 4 is all y2 and 5 to 7 switch back to y1.
+    inline static int Series(int combination, int i)
+    {
+        int first = (combination < 4) ? 0 : 1;
+        int switch_at = 4 - combination % 4;
+
+        return (combination % 4 != 0 && i >= switch_at) ? 1 - first : first;
+    }
+
+    //=========================================================================================================
+    // Testing
+    //=========================================================================================================
+    // Compares what Add finds with the third differences worked out from scratch, for every
+    // combination, on values that are sometimes natural cubics, sometimes not and sometimes mixed
+    inline static void Test()
+    {
+        __int64 seed = 12345;
+        auto next = [&seed](int range) { seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF; return (__int64)(seed % range); };
+
+        for (int trial = 0; trial < 200; ++trial)
+        {
+            CubicSpotterT spotter;
+            __int64 stride = 3 + next(5);
+            __int64 a1 = next(3), a2 = next(3);
+            __int64 b1 = next(20) - 10, b2 = next(20) - 10;
+            std::vector<__int64> y1s, y2s;
+
+            spotter.SetDelta(stride + next(2));
+
+            for (__int64 k = 0; k < 12; ++k)
+            {
+                __int64 y1 = a1 * k * k * k + b1 * k * k + 7 * k - 100;
+                __int64 y2 = a2 * k * k * k + b2 * k + 5;
+
+                if (next(8) == 0)
+                {
+                    y1 += next(3) - 1;      // Not a cubic any more
+                }
+
+                y1s.push_back(y1);
+                y2s.push_back(y2);
+
+                int found = spotter.Add(Int(1000 + stride * k), Int(y1), Int(y2));
+                int expected = 0;
+
+                for (int c = 0; k >= 3 && c < COMBINATIONS; ++c)
+                {
+                    __int64 v[4];
+
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        v[i] = (Series(c, i) == 0) ? y1s[k - 3 + i] : y2s[k - 3 + i];
+                    }
+
+                    if (-v[0] + 3 * v[1] - 3 * v[2] + v[3] == 6)
+                    {
+                        expected |= 1 << c;
+                    }
+                }
+
+                FourPointCubic cubic(VLInt(0), VLInt(0), VLInt(0), VLInt(0));
+
+                if (found != expected || (found != 0 && (! spotter.Cubic(cubic) || ! cubic.IsNatural())))
+                {
+                    std::stringstream sstrm;
+                    sstrm << "CubicSpotter test: trial " << trial << ", point " << k << ", found " << found << ", expected " << expected;
+                    throw std::runtime_error(sstrm.str().c_str());
+                }
+            }
+        }
+
+        // Looking ahead, against trying every step, on cubics with roots (and turns) spread over
+        // the range
+
+        for (int trial = 0; trial < 100; ++trial)
+        {
+            CubicSpotterT spotter;
+            __int64 r1 = next(300), r2 = r1 + next(20), r3 = next(300), shift = next(2000) - 1000;
+            auto f = [&](__int64 k) { return (k - r1) * (k - r2) * (k - r3) + shift; };
+            std::vector<__int64> expected;
+
+            spotter.SetDelta(5);
+
+            for (__int64 k = 0; k < 4; ++k)
+            {
+                spotter.Add(Int(5 * k), Int(f(k)), Int(f(k) + 1));
+            }
+
+            for (__int64 j = 1; j <= 400; ++j)
+            {
+                if (f(3 + j) < 100 && f(3 + j) > -100)
+                {
+                    expected.push_back(j);
+                }
+                if (spotter.Ahead(0, j) != Int(f(3 + j)))
+                {
+                    std::stringstream sstrm;
+                    sstrm << "CubicSpotter test: Ahead(" << j << ") = " << spotter.Ahead(0, j) << ", expected " << f(3 + j);
+                    throw std::runtime_error(sstrm.str().c_str());
+                }
+            }
+
+            if ((spotter.Found() & 1) == 0 || spotter.SmallAhead(0, 400, 100) != expected)
+            {
+                std::stringstream sstrm;
+                sstrm << "CubicSpotter test: SmallAhead trial " << trial << ", found " << spotter.Found() << ", expected " << expected.size() << " small values";
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+        }
+
+        // Finished
+
+        std::cout << "CubicSpotter: All tests passed." << std::endl;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    inline const Point& Newest() const
+    {
+        return m_ring[(m_count - 1) % CAPACITY];
+    }
+    //--------------------------------------------------------------------------------------------
+    // The point at x, if it is still in the ring
+    const Point * Find(const Int& x) const
+    {
+        for (int i = 1; i <= CAPACITY && i <= m_count; ++i)
+        {
+            auto& point = m_ring[(m_count - i) % CAPACITY];
+
+            if (point.x == x)
+            {
+                return &point;
+            }
+        }
+        return nullptr;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Sets up the new point's chain, following on from the point delta - 1 or delta before it.
+    // The gaps between points add up to how far back each one is, without going back to the x
+    // values.
+    void Extend(Point& point)
+    {
+        auto& chain = point.chain;
+        const Point * previous = nullptr;
+        __int64 span = point.gap;
+
+        chain.stride = 0;
+        chain.length = 1;
+
+        for (int i = 1; i < CAPACITY && i <= m_count && span <= delta; ++i)
+        {
+            if (span >= delta - 1 && span > 1)
+            {
+                previous = &m_ring[(m_count - i) % CAPACITY];
+                break;
+            }
+            span += m_ring[(m_count - i) % CAPACITY].gap;
+        }
+
+        if (previous == nullptr)
+        {
+            return;
+        }
+
+        auto& before = previous->chain;
+        Int d3[2];
+
+        chain.stride = span;
+        chain.length = (before.stride == span) ? before.length + 1 : 2;
+        chain.e1 = previous->e;
+
+        for (int v = 0; v < 2; ++v)
+        {
+            chain.d1[v] = point.y[v] - previous->y[v];
+
+            if (chain.length >= 3)
+            {
+                chain.d2[v] = chain.d1[v] - before.d1[v];
+            }
+            if (chain.length >= 4)
+            {
+                d3[v] = chain.d2[v] - before.d2[v];
+            }
+        }
+
+        if (chain.length < 4)
+        {
+            return;
+        }
+
+        // The switches to the other value, after the last 1, 2 or 3 points
+
+        Int six(6);
+        Int tail[3];
+
+        tail[0] = point.e;
+        tail[1] = tail[0] - chain.e1 - chain.e1 - chain.e1;
+        tail[2] = tail[1] + before.e1 + before.e1 + before.e1;
+
+        Int to_y2 = six - d3[0];        // y1 then y2 is natural if tail == this
+        Int to_y1 = d3[1] - six;
+
+        int found = 0;
+
+        found |= (d3[0] == six) ? 1 : 0;
+        found |= (d3[1] == six) ? 1 << 4 : 0;
+
+        for (int t = 0; t < 3; ++t)
+        {
+            found |= (tail[t] == to_y2) ? 1 << (t + 1) : 0;
+            found |= (tail[t] == to_y1) ? 1 << (t + 5) : 0;
+        }
+
+        if (found)
+        {
+            m_found = found;
+            m_found_stride = span;
+        }
+    }
 };
 
+typedef CubicSpotterT<VLInt> CubicSpotter;
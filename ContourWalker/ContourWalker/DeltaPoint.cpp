@@ -0,0 +1 @@
+#include "DeltaPoint.h"
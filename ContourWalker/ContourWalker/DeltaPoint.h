@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+
+#include "VLInt.h"
+#include "ContourPoint.h"
+#include "Checkpoint.h"
+#include "Result.h"
+
+//-------------------------------------------------------------------------------------------------
+// The same point as ContourPoint, y^3 - ((x+n)^3 - x^3), but only keeps the value and its
+// differences, not the cubes. The value stays close to zero and the differences only grow like
+// x^(4/3), so they fit in a native integer for far longer than the cubes do. Big integers are only
+// used to seed the point.
+//
+// Int is the integer type to use, DeltaPoint is the full width version
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+template <class Int>
+class DeltaPointT
+{
+    template <class> friend class DeltaPointT;
+
+    static const __int64 target = 1025L;
+    static const __int64 dddy = 6;   // 3rd derivative is constant
+
+    Int x;
+    Int y;
+    Int n;          // Contour
+    Int value;      // y^3 - ((x+n)^3 - x^3)
+    Int dv;         // Change in (x+n)^3 - x^3 when x goes up by 1, 6nx + 3n^2 + 3n
+    Int ddv;        // 6n
+    Int dy;         // Change in y^3 when y goes up by 1, 3y^2 + 3y + 1
+    Int ddy;        // 6y + 6
+
+public:
+
+    inline DeltaPointT() {}
+    //-------------------------------------------------------------------------------------------------
+    inline DeltaPointT(const DeltaPointT& other)
+        : x (other.x)
+        , y (other.y)
+        , n (other.n)
+        , value (other.value)
+        , dv (other.dv)
+        , ddv (other.ddv)
+        , dy (other.dy)
+        , ddy (other.ddy)
+    {
+    }
+    //-------------------------------------------------------------------------------------------------
+    // Convert from a different integer type
+    template <class Other>
+    inline explicit DeltaPointT(const DeltaPointT<Other>& other)
+        : x (other.x)
+        , y (other.y)
+        , n (other.n)
+        , value (other.value)
+        , dv (other.dv)
+        , ddv (other.ddv)
+        , dy (other.dy)
+        , ddy (other.ddy)
+    {
+    }
+    //-------------------------------------------------------------------------------------------------
+    // Same starting point as ContourPoint
+    inline DeltaPointT (__int64 contour)
+    {
+        auto start = ContourPoint::StartX(contour);
+
+        Seed(start, start, contour);
+    }
+    //-------------------------------------------------------------------------------------------------
+    // Same as ContourPoint::SeekTo
+    inline static DeltaPointT SeekTo(__int64 contour, const VLInt & x)
+    {
+        if (x <= ContourPoint::StartX(contour))
+        {
+            return DeltaPointT(contour);
+        }
+
+        auto row = ContourPoint::SeekRow(contour, x);
+        DeltaPointT ret(contour, row.first, row.second);
+
+        ret.IncrementCube();
+        return ret;
+    }
+    //-------------------------------------------------------------------------------------------------
+    // The point (x, y) on the contour
+    inline DeltaPointT (__int64 contour, const VLInt& _x, const VLInt& _y)
+    {
+        Seed(_x, _y, contour);
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline void Seed(const VLInt& _x, const VLInt& _y, __int64 contour)
+    {
+        VLInt vn (contour);
+
+        x = Int(_x);
+        y = Int(_y);
+        n = Int(vn);
+        value = Int(_y.Cube() - ((_x + vn).Cube() - _x.Cube()));
+        dv = Int((_x * 6 + 3) * contour + vn.Square() * 3);
+        ddv = Int(vn * 6);
+        dy = Int((_y.Square() + _y) * 3 + 1);
+        ddy = Int((_y + 1) * 6);
+    }
+    //-------------------------------------------------------------------------------------------------
+    // How far x can go before dv or dy no longer fit in 'bits' bits, returns 0 if the walk can't
+    // start. dv <= 9n(x+n) and dy <= 4y^2 <= 4(3n)^(2/3)(x+n)^(4/3), both are kept 4 bits clear of
+    // the limit and then x is halved so that the row in progress can't overflow.
+
+    inline static VLInt MaxX(__int64 contour, int bits)
+    {
+        double dn = (double)contour;
+        double log_dv = bits - 4 - log2(9 * dn);
+        double log_dy = (bits - 6 - log2(3 * dn) * 2 / 3) * 0.75;
+        auto max_x = VLInt(2).Pow((int)std::min(log_dv, log_dy) - 1) - contour;
+
+        return (max_x > VLInt(contour) * 4) ? max_x : VLInt(0);
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline const Int& X() const { return x; }
+    inline const Int& Y() const { return y; }
+    inline const Int& N() const { return n; }
+    inline const Int& Value() const { return value; }
+    inline const Int& DV() const { return dv; }
+    inline bool IsPositive() const { return value.IsPositive(); }
+    //-------------------------------------------------------------------------------------------------
+    inline DeltaPointT GetNextX () const
+    {
+        auto ret = (*this);
+        ret.IncrementSub();
+        return ret;
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline DeltaPointT GetNextY () const
+    {
+        auto ret = (*this);
+        ret.IncrementCube();
+        return ret;
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline DeltaPointT GetPreviousX () const
+    {
+        auto ret = (*this);
+        ret.DecrementSub();
+        return ret;
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline DeltaPointT GetPreviousY () const
+    {
+        auto ret = (*this);
+        ret.DecrementCube();
+        return ret;
+    }
+    //----------------------------------------------------------------------------------------------------------------
+    inline void DecrementSub ()
+    {
+        --x;
+        dv -= ddv;
+        value += dv;
+    }
+    //----------------------------------------------------------------------------------------------------------------
+    inline void IncrementSub ()
+    {
+        value -= dv;
+        dv += ddv;
+        ++x;
+    }
+    //----------------------------------------------------------------------------------------------------------------
+    inline void DecrementCube ()
+    {
+        ddy = ddy - dddy;
+        dy -= ddy;
+        value -= dy;
+        --y;
+    }
+    //----------------------------------------------------------------------------------------------------------------
+    inline void IncrementCube ()
+    {
+        value += dy;
+        dy += ddy;
+        ddy = ddy + dddy;
+        ++y;
+    }
+    //----------------------------------------------------------------------------------------------------------------
+    // The sum of dv over the next hop steps is hop.dv + ddv.hop(hop-1)/2
+    inline void HopSub (__int64 hop)
+    {
+        auto a = (hop % 2 == 0) ? hop / 2 : hop;
+        auto b = (hop % 2 == 0) ? hop - 1 : (hop - 1) / 2;
+
+        value -= dv * hop;
+        value -= ddv * a * b;
+        dv += ddv * hop;
+        x = x + hop;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline Result GetResult() const
+    {
+        return Result(VLInt(x), VLInt(y), VLInt(x + n), VLInt(value));
+    }
+    //--------------------------------------------------------------------------------------------
+    inline bool TestValue () const
+    {
+        return value.TestSmall(target);
+    }
+    //--------------------------------------------------------------------------------------------
+    // TestValue for the point before this one along the row, the last IncrementSub took off
+    // dv - ddv
+    inline bool TestPreviousX () const
+    {
+        return (value + dv - ddv).TestSmall(target);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Checkpoints
+    //--------------------------------------------------------------------------------------------
+    inline void Save(std::ostream& os) const
+    {
+        for (auto p : { &x, &y, &n, &value, &dv, &ddv, &dy, &ddy })
+        {
+            Checkpoint::WriteInt(os, *p);
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    inline void Load(std::istream& is)
+    {
+        for (auto p : { &x, &y, &n, &value, &dv, &ddv, &dy, &ddy })
+        {
+            *p = Checkpoint::ReadInt<Int>(is);
+        }
+    }
+    //=========================================================================================================
+    // Monitoring and Testing
+    //=========================================================================================================
+
+    inline std::string ToString () const
+    {
+        std::stringstream sstrm;
+        sstrm << "[Contour = " << n << " (" << x << "," << y << ") = " << value;
+
+        return sstrm.str();
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline friend std::ostream& operator << (std::ostream& os, const DeltaPointT& cp)
+    {
+        return os << cp.ToString();
+    }
+    //------------------------------------------------------------------------------------------------------
+    // Follows the same steps as a ContourPoint and checks that they agree
+    template <class Reference>
+    inline static void Test(__int64 contour)
+    {
+        // The start is the first x with 2x^3 >= (x + n)^3, also past where a double would manage it
+
+        for (__int64 c : { contour, contour * 1000000007 })
+        {
+            auto x = ContourPoint::StartX(c);
+
+            if (x.Cube() * 2 < (x + c).Cube() || (x - 1).Cube() * 2 >= (x - 1 + c).Cube())
+            {
+                std::stringstream sstrm;
+                sstrm << "Start x for contour " << c << " = " << x;
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+        }
+
+        Reference ref(contour);
+        DeltaPointT dp(contour);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            switch (i % 7)
+            {
+            case 0: case 2: case 3:
+                ref.IncrementSub();
+                dp.IncrementSub();
+                break;
+
+            case 1: case 5:
+                ref.IncrementCube();
+                dp.IncrementCube();
+                break;
+
+            case 4:
+                ref.HopSub(i);
+                dp.HopSub(i);
+                break;
+
+            case 6:
+                ref.DecrementSub();
+                dp.DecrementSub();
+                break;
+            }
+
+            if (VLInt(dp.x) != VLInt(ref.X()) || VLInt(dp.y) != VLInt(ref.Y()) || VLInt(dp.value) != VLInt(ref.Value()))
+            {
+                std::stringstream sstrm;
+                sstrm << "DeltaPoint step " << i << ": " << dp << " != " << ref;
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+        }
+
+        // Finished
+
+        std::cout << "DeltaPoint: All tests passed." << std::endl;
+    }
+
+}; // class
+
+typedef DeltaPointT<VLInt> DeltaPoint;
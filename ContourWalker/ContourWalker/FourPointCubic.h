@@ -78,7 +78,7 @@ public:
 
 			sstrm << "Expected a = 8, got " << fpc;
 
-			throw std::exception(sstrm.str().c_str());
+			throw std::runtime_error(sstrm.str().c_str());
 		}
 
 		if (fpc.b.ToInt() != 12)
@@ -87,7 +87,7 @@ public:
 
 			sstrm << "Expected b = 12, got " << fpc;
 
-			throw std::exception(sstrm.str().c_str());
+			throw std::runtime_error(sstrm.str().c_str());
 		}
 
 		if (fpc.c.ToInt() != 6)
@@ -96,7 +96,7 @@ public:
 
 			sstrm << "Expected c = 6, got " << fpc;
 
-			throw std::exception(sstrm.str().c_str());
+			throw std::runtime_error(sstrm.str().c_str());
 		}
 
 		if (fpc.d.ToInt() != 1)
@@ -105,7 +105,7 @@ public:
 
 			sstrm << "Expected d = 1, got " << fpc;
 
-			throw std::exception(sstrm.str().c_str());
+			throw std::runtime_error(sstrm.str().c_str());
 		}
 
 		auto f5 = fpc.Value (VLInt(5)).ToInt();
@@ -116,7 +116,7 @@ public:
 
 			sstrm << "Expected f(5) = 1331, got " << f5;
 
-			throw std::exception(sstrm.str().c_str());
+			throw std::runtime_error(sstrm.str().c_str());
 		}
 
 		// Finished
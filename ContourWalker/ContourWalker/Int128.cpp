@@ -0,0 +1 @@
+#include "Int128.h"
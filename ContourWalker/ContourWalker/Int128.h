@@ -0,0 +1,249 @@
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// A signed 128 bit integer with the same interface as VLInt, so that the walker templates can run
+// on native arithmetic while the numbers are small. There are no overflow checks, the caller must
+// keep the values in range (see ContourPointT::MaxX and DeltaPointT::MaxX).
+//
+// Only available where the compiler has __int128 (GCC and Clang on 64 bit targets).
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __SIZEOF_INT128__
+
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <iostream>
+#include <limits>
+
+#include "VLInt.h"
+
+class Int128
+{
+    __int128 value{ 0 };
+
+public:
+
+    static const int BITS = 127;    // Not counting the sign
+
+    inline Int128() {}
+    //--------------------------------------------------------------------------------------------
+    inline Int128(__int64 n) : value(n) {}
+    //--------------------------------------------------------------------------------------------
+    inline Int128(const Int128& other) : value(other.value) {}
+    //--------------------------------------------------------------------------------------------
+    // Throws if the value doesn't fit
+    template <int N>
+    inline explicit Int128(const VLIntN<N>& other)
+    {
+        static const __int64 base = 1LL << 32;
+
+        auto mag = other.value;
+        unsigned __int128 ret = 0;
+
+        for (int shift = 0; shift < 128 && ! mag.IsZero(); shift += 32)
+        {
+            auto dm = mag.DivMod(base);
+
+            ret |= (unsigned __int128)dm.second << shift;
+            mag = dm.first;
+        }
+
+        if (! mag.IsZero() || (ret >> BITS) != 0)
+        {
+            throw std::overflow_error("Int128 overflow");
+        }
+
+        value = other.IsPositive() ? (__int128)ret : -(__int128)ret;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline Int128& operator = (const Int128& other)
+    {
+        value = other.value;
+        return (*this);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline Int128& operator = (__int64 other)
+    {
+        value = other;
+        return (*this);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline bool TestSmall(int target) const
+    {
+        return value < target && value > -target;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline Int128 operator * (__int64 num) const { return FromNative(value * num); }
+    inline Int128 operator * (const Int128& other) const { return FromNative(value * other.value); }
+    inline Int128 operator + (__int64 num) const { return FromNative(value + num); }
+    inline Int128 operator + (const Int128& other) const { return FromNative(value + other.value); }
+    inline Int128 operator - (__int64 num) const { return FromNative(value - num); }
+    inline Int128 operator - (const Int128& other) const { return FromNative(value - other.value); }
+    inline Int128 operator - () const { return FromNative(-value); }
+    inline Int128& operator += (const Int128& other) { value += other.value; return (*this); }
+    inline Int128& operator -= (const Int128& other) { value -= other.value; return (*this); }
+    //--------------------------------------------------------------------------------------------
+    inline Int128& operator ++ ()
+    {
+        ++value;
+        return (*this);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline Int128 operator ++ (int)
+    {
+        Int128 temp = *this;
+
+        ++value;
+        return temp;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline Int128& operator -- ()
+    {
+        --value;
+        return (*this);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline Int128 operator -- (int)
+    {
+        Int128 temp = *this;
+
+        --value;
+        return temp;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline bool operator > (const Int128& other) const { return value > other.value; }
+    inline bool operator >= (const Int128& other) const { return value >= other.value; }
+    inline bool operator < (const Int128& other) const { return value < other.value; }
+    inline bool operator <= (const Int128& other) const { return value <= other.value; }
+    inline bool operator == (const Int128& other) const { return value == other.value; }
+    inline bool operator != (const Int128& other) const { return value != other.value; }
+    //--------------------------------------------------------------------------------------------
+    inline Int128 Abs() const { return FromNative(value < 0 ? -value : value); }
+    inline bool IsZero() const { return value == 0; }
+    inline bool IsPositive() const { return value >= 0; }
+    //------------------------------------------------------------------------------------------------------
+    inline Int128 Square() const { return FromNative(value * value); }
+    inline Int128 Cube() const { return FromNative(value * value * value); }
+    //------------------------------------------------------------------------------------------------------
+    // Don't define operator so that we don't call this by mistake
+    inline __int64 ToInt() const
+    {
+        if (value > std::numeric_limits<__int64>::max() || value < std::numeric_limits<__int64>::min())
+        {
+            throw std::invalid_argument("Overflow");
+        }
+        return (__int64)value;
+    }
+    //------------------------------------------------------------------------------------------------------
+    // Convert to a big integer, used to hand the walker over when the numbers get too big
+    template <int N>
+    inline explicit operator VLIntN<N>() const
+    {
+        static const VLUIntN<N> base(1LL << 32);
+
+        unsigned __int128 mag = (value < 0) ? -(unsigned __int128)value : (unsigned __int128)value;
+
+        VLUIntN<N> ret(0);
+
+        for (int shift = 96; shift >= 0; shift -= 32)
+        {
+            ret = ret * base + (__int64)((mag >> shift) & 0xffffffff);
+        }
+
+        return VLIntN<N>(ret, value >= 0);
+    }
+    //=========================================================================================================
+    // Monitoring and Testing
+    //=========================================================================================================
+    inline std::string ToString() const
+    {
+        return VLInt(*this).ToString();
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline friend std::ostream& operator << (std::ostream& os, const Int128& n)
+    {
+        return os << n.ToString();
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline static void Test()
+    {
+        // Cubes near the top of the range should match VLInt
+
+        Int128 x(2000000000000LL);
+        VLInt vlx(2000000000000LL);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            auto c = VLInt(x.Cube());
+            auto vc = vlx.Cube();
+
+            if (c != vc)
+            {
+                std::stringstream sstrm;
+                sstrm << "Cube test: " << x << "^3 = " << c << ", expected " << vc;
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+
+            if (VLInt(-x) != -vlx)
+            {
+                std::stringstream sstrm;
+                sstrm << "Negate test: " << VLInt(-x) << " != " << -vlx;
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+
+            x = x + 123456789;
+            vlx = vlx + 123456789;
+        }
+
+        // Conversion from VLInt beyond the __int64 range
+
+        auto big = VLInt(-3).Pow(79);       // About -2^125
+
+        if (VLInt(Int128(big)) != big || VLInt(Int128(-big)) != -big)
+        {
+            std::stringstream sstrm;
+            sstrm << "Conversion test: " << Int128(big) << " != " << big;
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+
+        try
+        {
+            Int128 overflow(big * 9);       // About -2^128
+            throw std::runtime_error("Conversion test: no overflow");
+        }
+        catch (std::overflow_error&)
+        {
+        }
+
+        // Small values
+
+        Int128 a(-20);
+
+        if (a.Cube().ToInt() != -8000 || a.ToString() != "-20" || !a.TestSmall(21) || a.TestSmall(20))
+        {
+            std::stringstream sstrm;
+            sstrm << "Small value test: " << a << "^3 = " << a.Cube();
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+
+        // Finished
+
+        std::cout << "Int128: All tests passed." << std::endl;
+    }
+
+private:
+
+    inline static Int128 FromNative(__int128 n)
+    {
+        Int128 ret;
+
+        ret.value = n;
+        return ret;
+    }
+};
+
+#endif
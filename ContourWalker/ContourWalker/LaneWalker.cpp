@@ -0,0 +1 @@
+#include "LaneWalker.h"
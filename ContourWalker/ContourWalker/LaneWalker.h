@@ -0,0 +1,679 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ContourWalker.h"
+#include "CpuDispatch.h"
+#include "Trace.h"
+
+//-------------------------------------------------------------------------------------------------
+// Steps up to LANES ContourWalkers a chunk at a time, in lockstep, one walker per lane. The
+// walkers' arithmetic is sign and magnitude VLIntN, one number at a time. Here each lane keeps its
+// value and differences as two's complement limbs, stored limb by limb across the lanes
+// ([limb][lane]), so that every limb of an add or compare is the same operation on all the lanes
+// and compiles to vector instructions. The rows are built for generic x86, AVX2 and AVX-512, and
+// run on the best the CPU has (CpuDispatch). Lanes are masked, not branched on: a lane that has
+// reached its crossing, or finished its chunk, adds zeros.
+//
+// The lanes only walk the usual rows, a hop, up to linear_steps steps and the step up. A row that
+// needs anything else (a gallop, a result, a bigger hop_max or the first row of a walk) goes back
+// to the lane's walker, which finishes it with EndRow, so results are found and stored exactly as
+// they are by ContourWalkerT::Step. The walkers end each chunk where Step would have left them.
+//
+// Int is the walkers' integer type, it needs a limit (Int::BITS != 0). Point is ContourPointT or
+// DeltaPointT.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+template <class Int, template <class> class Point>
+class LaneWalkerT
+{
+public:
+
+    typedef ContourWalkerT<Int, Point<Int>> Walker;
+
+    static const int LANES = 8;
+
+private:
+
+    typedef VLLimb Limb;
+    typedef uint64_t Wide;
+
+    static const int LIMBS = (Int::BITS > 0) ? Int::BITS / 32 : 2;
+    static const int MIN_WIDTH = 2;             // For the sign and TestSmall
+    static const __int64 target = 1025L;        // As ContourPoint
+    static const __int64 NO_END = (__int64)1 << 62;
+
+    // One number per lane, limb i of lane l is limb[i][l]
+
+    struct Lanes
+    {
+        Limb limb[LIMBS][LANES];
+    };
+
+    Lanes m_value;
+    Lanes m_dv;
+    Lanes m_ddv;
+    Lanes m_dy;
+    Lanes m_ddy;
+    Lanes m_hop_ddv;                // ddv * hop
+    Lanes m_hop_ddv2;               // ddv * h1 * h2, see SubCube::Hop
+    Lanes m_temp;
+    int m_width{ MIN_WIDTH };       // Limbs in use, the rest are ignored
+
+    int m_count{ 0 };
+    Walker * m_walker[LANES];
+    __int64 m_contour[LANES];
+    VLInt m_x[LANES];               // Where the lane was loaded from its walker
+    VLInt m_y[LANES];
+    __int64 m_moved[LANES];         // Along and up since then
+    __int64 m_up[LANES];
+    __int64 m_steps[LANES];         // Steps along the rows since then, for the walker's counters
+    Wide m_hop_along[LANES];        // The hop taken at the start of each row, 0 for none
+    __int64 m_hop_max[LANES];
+    __int64 m_room[LANES];          // How much further x can go, end x - x
+    __int64 m_rows[LANES];          // Rows walked this chunk
+    __int64 m_chunk_rows[LANES];    // Rows left in the chunk when it started
+    bool m_crossed[LANES];          // The walker has a cross
+
+public:
+
+    //--------------------------------------------------------------------------------------------
+    inline void Clear()
+    {
+        m_count = 0;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline int Count() const
+    {
+        return m_count;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline void Add(Walker * walker, __int64 contour)
+    {
+        if (m_count == LANES)
+        {
+            throw std::runtime_error("LaneWalker: no free lane");
+        }
+
+        m_walker[m_count] = walker;
+        m_contour[m_count] = contour;
+        ++m_count;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Steps every walker one chunk, more[lane] is what its Step would have returned
+    void Step(bool * more)
+    {
+        Trace::Span span("lanes");
+        bool stepping[LANES];
+
+        m_width = MIN_WIDTH;
+
+        for (int l = 0; l < LANES; ++l)
+        {
+            stepping[l] = l < m_count && m_walker[l]->CanStep();
+            m_rows[l] = 0;
+            m_chunk_rows[l] = stepping[l] ? m_walker[l]->m_chunk - m_walker[l]->m_row : 0;
+
+            if (stepping[l])
+            {
+                Load(l);
+            }
+            else
+            {
+                Idle(l);
+            }
+        }
+
+        Fill();
+
+        for (int l = 0; l < m_count; ++l)
+        {
+            more[l] = false;
+
+            if (stepping[l])
+            {
+                Store(l);
+                more[l] = m_walker[l]->EndChunk();
+            }
+        }
+    }
+
+    //=========================================================================================================
+    // Testing
+    //=========================================================================================================
+    // Contours walked in lanes find the same results, in the same order, stop in the same place
+    // and count the same steps and hops as when they are walked on their own. Odd contour counts
+    // leave lanes empty, and the walks end at different places so lanes drop out part way
+    // through a chunk. On each instruction set the CPU has.
+    inline static void Test()
+    {
+        auto level = CpuDispatch::Level();
+
+        for (auto isa : { CpuDispatch::GENERIC, CpuDispatch::AVX2, CpuDispatch::AVX512 })
+        {
+            if (isa <= CpuDispatch::Detect())
+            {
+                CpuDispatch::Select(CpuDispatch::Name(isa));
+                TestLanes();
+            }
+        }
+
+        CpuDispatch::Select(CpuDispatch::Name(level));
+
+        // Finished
+
+        std::cout << "LaneWalker: All tests passed." << std::endl;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    inline static void TestLanes()
+    {
+        __int64 contours[] = { 2, 5, 7, 20, 33, 1000, 1001, 123457, 2, 9 };
+        const int count = sizeof(contours) / sizeof(contours[0]);
+        VLInt end(3000000);
+
+        for (int first = 0; first < count; first += LANES)
+        {
+            int last = std::min(count, first + LANES);
+            std::vector<std::unique_ptr<Walker>> alone;
+            std::vector<std::unique_ptr<Walker>> laned;
+            LaneWalkerT lanes;
+
+            for (int i = first; i < last; ++i)
+            {
+                auto end_x = end - i * 10007;
+
+                alone.emplace_back(new Walker(contours[i], 0, 700, end_x));
+                laned.emplace_back(new Walker(contours[i], 0, 700, end_x));
+                alone.back()->SetQuiet(true);
+                alone.back()->Walk();
+                laned.back()->SetQuiet(true);
+                laned.back()->Start();
+                lanes.Add(laned.back().get(), contours[i]);
+            }
+
+            bool more[LANES];
+
+            do
+            {
+                lanes.Step(more);
+            } while (std::any_of(more, more + lanes.Count(), [](bool m) { return m; }));
+
+            for (int i = 0; i < last - first; ++i)
+            {
+                auto& expected = alone[i]->Results().Found();
+                auto& found = laned[i]->Results().Found();
+                bool same = expected.size() == found.size() && alone[i]->Rows() == laned[i]->Rows() && VLInt(alone[i]->X()) == VLInt(laned[i]->X());
+                auto& counted = alone[i]->m_counters;
+                auto& lane_counted = laned[i]->m_counters;
+
+                same = same && counted.rows == lane_counted.rows && counted.x_steps == lane_counted.x_steps && counted.hops == lane_counted.hops
+                            && counted.results == lane_counted.results && std::equal(counted.hop_sizes, counted.hop_sizes + WalkCounters::BUCKETS, lane_counted.hop_sizes);
+
+                for (size_t j = 0; same && j < found.size(); ++j)
+                {
+                    same = found[j].Key() == expected[j].Key();
+                }
+
+                if (! same)
+                {
+                    std::stringstream sstrm;
+                    sstrm << "LaneWalker test (" << CpuDispatch::Name(CpuDispatch::Level()) << "): contour " << contours[first + i] << " found " << found.size() << " results in " << laned[i]->Rows()
+                          << " rows, expected " << expected.size() << " in " << alone[i]->Rows();
+                    throw std::runtime_error(sstrm.str().c_str());
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------
+    // Rows in lockstep until every lane has finished its chunk, on the CPU's best instruction set
+    void Fill()
+    {
+        switch (CpuDispatch::Level())
+        {
+        case CpuDispatch::AVX512:
+            FillAvx512();
+            break;
+        case CpuDispatch::AVX2:
+            FillAvx2();
+            break;
+        default:
+            FillRows();
+            break;
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    TARGET_AVX512 void FillAvx512()
+    {
+        FillRows();
+    }
+    //--------------------------------------------------------------------------------------------
+    TARGET_AVX2 void FillAvx2()
+    {
+        FillRows();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Fill, inlined into each build of it with everything it calls in the rows
+    FORCE_INLINE void FillRows()
+    {
+        Limb active[LANES];
+        Limb flagged[LANES];
+        Limb mask[LANES];
+        Limb here[LANES];
+        Limb other[LANES];
+        Wide hop[LANES];
+        int count[LANES];
+
+        for (;;)
+        {
+            bool any = false;
+
+            for (int l = 0; l < LANES; ++l)
+            {
+                bool walking = m_rows[l] < m_chunk_rows[l] && m_room[l] >= 0;
+
+                active[l] = walking ? ~(Limb)0 : 0;
+                hop[l] = walking ? m_hop_along[l] : 0;
+                count[l] = 0;
+                any = any || walking;
+            }
+
+            if (! any)
+            {
+                return;
+            }
+
+            // The hop, as SubCube::Hop, value -= dv * hop + ddv * h1 * h2 and dv += ddv * hop. Only
+            // dv changes from row to row, the ddv terms are set up by Load.
+
+            Zero(m_temp);
+            MulAdd(m_temp, m_dv, hop);
+            Add(m_temp, m_hop_ddv2, active);
+            Sub(m_value, m_temp, active);
+            Add(m_dv, m_hop_ddv, active);
+
+            // Steps to the crossing, lanes that are on it stop
+
+            for (int step = 0; step < Walker::linear_steps; ++step)
+            {
+                Sign(m_value, mask);
+
+                for (int l = 0; l < LANES; ++l)
+                {
+                    mask[l] = active[l] & ~mask[l];
+                    count[l] += mask[l] & 1;
+                }
+
+                Sub(m_value, m_dv, mask);
+                Add(m_dv, m_ddv, mask);
+            }
+
+            // Anything the walker needs to see: still positive (a gallop), a small value at the
+            // previous x, here or in the row above, the first row of a walk or a new hop_max
+
+            Sign(m_value, flagged);
+            Small(m_value, here);
+
+            Copy(m_temp, m_value);
+            Add(m_temp, m_dv, active);
+            Sub(m_temp, m_ddv, active);
+            Small(m_temp, other);
+
+            for (int l = 0; l < LANES; ++l)
+            {
+                Limb previous = count[l] ? other[l] : here[l];
+                Limb special = (m_crossed[l] && (__int64)hop[l] + count[l] <= m_hop_max[l]) ? 0 : ~(Limb)0;
+
+                flagged[l] = active[l] & (~flagged[l] | previous | here[l] | special);
+            }
+
+            Copy(m_temp, m_value);
+            Add(m_temp, m_dy, active);
+            Small(m_temp, other);
+
+            for (int l = 0; l < LANES; ++l)
+            {
+                flagged[l] |= active[l] & other[l];
+                mask[l] = active[l] & ~flagged[l];
+            }
+
+            // The step up, as BigCube, value += dy, dy += ddy, ddy += 6
+
+            Add(m_value, m_dy, mask);
+            Add(m_dy, m_ddy, mask);
+            AddSmall(m_ddy, 6, mask);
+
+            for (int l = 0; l < LANES; ++l)
+            {
+                if (mask[l])
+                {
+                    auto d = (__int64)hop[l] + count[l];
+
+                    m_moved[l] += d;
+                    m_room[l] -= d;
+                    m_up[l] += 1;
+                    m_steps[l] += count[l];
+                    m_rows[l] += 1;
+                }
+                else if (flagged[l])
+                {
+                    EndRow(l, (__int64)hop[l] + count[l], count[l]);
+                }
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Hands the lane's row to its walker, moved along it so far, after count steps
+    void EndRow(int l, __int64 moved, int count)
+    {
+        auto walker = m_walker[l];
+        auto x = m_x[l] + m_moved[l];
+
+        walker->current = Point<Int>(m_contour[l], x + moved, m_y[l] + m_up[l]);
+        walker->cross = m_crossed[l] ? Int(x) : Int(0);
+        walker->hop = 0;
+        Count(l, m_up[l] + 1, m_steps[l] + count);
+        walker->EndRow(count);
+
+        m_rows[l] += 1;
+        Load(l);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Sets the lane up from its walker, widening the lanes if its numbers need more limbs
+    void Load(int l)
+    {
+        auto walker = m_walker[l];
+        VLInt x(walker->current.X());
+        VLInt y(walker->current.Y());
+        VLInt n(m_contour[l]);
+        auto dv = (x * 6 + 3) * n + n.Square() * 3;
+        auto dy = (y.Square() + y) * 3 + 1;
+
+        // Values along a row stay within dy and what a hop takes off, under dv * (hop + 1)^2,
+        // with room for the sign and for the row to grow. Walks too far for Int never get here.
+
+        auto h = walker->hop_max + Walker::linear_steps + 2;
+        auto bits = std::max(dv.value.BitLength(), dy.value.BitLength()) + 2 * VLUInt(h).BitLength() + 1;
+
+        Widen((bits / 32 + 2 < LIMBS) ? bits / 32 + 2 : LIMBS);
+
+        m_x[l] = x;
+        m_y[l] = y;
+        m_moved[l] = 0;
+        m_up[l] = 0;
+        m_steps[l] = 0;
+        m_hop_max[l] = walker->hop_max;
+        m_crossed[l] = ! walker->cross.IsZero();
+        m_room[l] = NO_END;
+
+        if (! walker->m_end_x.IsZero())
+        {
+            auto room = VLInt(walker->m_end_x) - x;
+
+            m_room[l] = (room < VLInt(NO_END)) ? room.ToInt() : NO_END;
+        }
+
+        Set(m_value, l, VLInt(walker->current.Value()));
+        Set(m_dv, l, dv);
+        Set(m_ddv, l, n * 6);
+        Set(m_dy, l, dy);
+        Set(m_ddy, l, (y + 1) * 6);
+
+        __int64 hop = (walker->hop >= 2) ? walker->hop : 0;
+        __int64 h1 = (hop % 2 == 0) ? hop / 2 : hop;
+        __int64 h2 = (hop % 2 == 0) ? hop - 1 : (hop - 1) / 2;
+
+        m_hop_along[l] = hop;
+        Set(m_hop_ddv, l, n * 6 * hop);
+        Set(m_hop_ddv2, l, hop ? n * 6 * h1 * h2 : VLInt(0));
+    }
+    //--------------------------------------------------------------------------------------------
+    // A lane with no walker, or one with nothing left to walk, is all zeros
+    void Idle(int l)
+    {
+        m_room[l] = -1;
+        m_hop_along[l] = 0;
+        m_hop_max[l] = 0;
+        m_crossed[l] = true;
+
+        for (auto lanes : { &m_value, &m_dv, &m_ddv, &m_dy, &m_ddy, &m_hop_ddv, &m_hop_ddv2 })
+        {
+            for (int i = 0; i < LIMBS; ++i)
+            {
+                lanes->limb[i][l] = 0;
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Leaves the walker where it would be after walking the lane's rows itself
+    void Store(int l)
+    {
+        auto walker = m_walker[l];
+
+        if (m_moved[l] != 0 || m_up[l] != 0)
+        {
+            auto x = m_x[l] + m_moved[l];
+
+            walker->current = Point<Int>(m_contour[l], x, m_y[l] + m_up[l]);
+            walker->cross = Int(x);
+        }
+
+        Count(l, m_up[l], m_steps[l]);
+        walker->m_row += m_rows[l];
+    }
+    //--------------------------------------------------------------------------------------------
+    // Adds the lane's rows since Load to its walker's counters, hops of them took the lane's hop
+    // and steps were taken along them. A row handed to the walker counts its own step up.
+    void Count(int l, __int64 hops, __int64 steps)
+    {
+        auto& counters = m_walker[l]->m_counters;
+
+        counters.rows += m_up[l];
+        counters.x_steps += steps;
+
+        if (m_hop_along[l] >= 2)
+        {
+            counters.Hop(m_hop_along[l], hops);
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Two's complement, sign extended to all the limbs
+    inline void Set(Lanes& lanes, int l, const VLInt& number)
+    {
+        Wide carry = number.positive ? 0 : 1;
+        Limb flip = number.positive ? 0 : ~(Limb)0;
+
+        for (int i = 0; i < LIMBS; ++i)
+        {
+            Limb limb = (i < number.value.length) ? number.value.value[i] : 0;
+            Wide sum = (Wide)(Limb)(limb ^ flip) + carry;
+
+            lanes.limb[i][l] = (Limb)sum;
+            carry = sum >> 32;
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Sign extends every lane to width limbs
+    void Widen(int width)
+    {
+        for (auto lanes : { &m_value, &m_dv, &m_ddv, &m_dy, &m_ddy, &m_hop_ddv, &m_hop_ddv2 })
+        {
+            for (int i = m_width; i < width; ++i)
+            {
+                for (int l = 0; l < LANES; ++l)
+                {
+                    lanes->limb[i][l] = (Limb)((int32_t)lanes->limb[m_width - 1][l] >> 31);
+                }
+            }
+        }
+        m_width = std::max(m_width, width);
+    }
+    //--------------------------------------------------------------------------------------------
+    // All 1s for negative lanes, all 0s for the rest
+    FORCE_INLINE void Sign(const Lanes& lanes, Limb * sign) const
+    {
+        for (int l = 0; l < LANES; ++l)
+        {
+            sign[l] = (Limb)((int32_t)lanes.limb[m_width - 1][l] >> 31);
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // TestSmall, all 1s where -target < value < target. That's value + target - 1 in [0, 2 target - 2],
+    // so either the upper limbs are 0 and the low one is in range, or they are all 1s and adding
+    // to the low one carries out of it.
+    FORCE_INLINE void Small(const Lanes& lanes, Limb * small) const
+    {
+        Limb upper_or[LANES];
+        Limb upper_and[LANES];
+
+        for (int l = 0; l < LANES; ++l)
+        {
+            upper_or[l] = 0;
+            upper_and[l] = ~(Limb)0;
+        }
+
+        for (int i = 1; i < m_width; ++i)
+        {
+            for (int l = 0; l < LANES; ++l)
+            {
+                upper_or[l] |= lanes.limb[i][l];
+                upper_and[l] &= lanes.limb[i][l];
+            }
+        }
+
+        for (int l = 0; l < LANES; ++l)
+        {
+            Wide low = (Wide)lanes.limb[0][l] + (target - 1);
+            bool in_range = (upper_or[l] == 0 && low < (Wide)(2 * target - 1)) || (upper_and[l] == ~(Limb)0 && (low >> 32) != 0);
+
+            small[l] = in_range ? ~(Limb)0 : 0;
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // The arithmetic. Each limb is one pass across the lanes with the carries in a Wide per lane.
+    //--------------------------------------------------------------------------------------------
+    FORCE_INLINE void Zero(Lanes& r) const
+    {
+        for (int i = 0; i < m_width; ++i)
+        {
+            for (int l = 0; l < LANES; ++l)
+            {
+                r.limb[i][l] = 0;
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    FORCE_INLINE void Copy(Lanes& r, const Lanes& a) const
+    {
+        for (int i = 0; i < m_width; ++i)
+        {
+            for (int l = 0; l < LANES; ++l)
+            {
+                r.limb[i][l] = a.limb[i][l];
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // r += a where mask is set
+    FORCE_INLINE void Add(Lanes& r, const Lanes& a, const Limb * mask) const
+    {
+        Wide carry[LANES] = { 0 };
+
+        for (int i = 0; i < m_width; ++i)
+        {
+            for (int l = 0; l < LANES; ++l)
+            {
+                Wide sum = (Wide)r.limb[i][l] + (a.limb[i][l] & mask[l]) + carry[l];
+
+                r.limb[i][l] = (Limb)sum;
+                carry[l] = sum >> 32;
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // r -= a where mask is set, as r + ~a + 1 (r + 0 + 0 where it isn't)
+    FORCE_INLINE void Sub(Lanes& r, const Lanes& a, const Limb * mask) const
+    {
+        Wide carry[LANES];
+
+        for (int l = 0; l < LANES; ++l)
+        {
+            carry[l] = mask[l] & 1;
+        }
+
+        for (int i = 0; i < m_width; ++i)
+        {
+            for (int l = 0; l < LANES; ++l)
+            {
+                Wide sum = (Wide)r.limb[i][l] + (~a.limb[i][l] & mask[l]) + carry[l];
+
+                r.limb[i][l] = (Limb)sum;
+                carry[l] = sum >> 32;
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    FORCE_INLINE void AddSmall(Lanes& r, Limb number, const Limb * mask) const
+    {
+        Wide carry[LANES];
+
+        for (int l = 0; l < LANES; ++l)
+        {
+            carry[l] = number & mask[l];
+        }
+
+        for (int i = 0; i < m_width; ++i)
+        {
+            for (int l = 0; l < LANES; ++l)
+            {
+                Wide sum = (Wide)r.limb[i][l] + carry[l];
+
+                r.limb[i][l] = (Limb)sum;
+                carry[l] = sum >> 32;
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // r += a * m, a is not negative. m is split into two 32 bit halves so that each limb product
+    // plus the carry fits in a Wide, the top half is usually 0 in every lane.
+    FORCE_INLINE void MulAdd(Lanes& r, const Lanes& a, const Wide * m) const
+    {
+        Wide top = 0;
+
+        for (int l = 0; l < LANES; ++l)
+        {
+            top |= m[l] >> 32;
+        }
+
+        for (int half = 0; half < (top ? 2 : 1); ++half)
+        {
+            Wide carry[LANES] = { 0 };
+            Wide factor[LANES];
+
+            for (int l = 0; l < LANES; ++l)
+            {
+                factor[l] = (m[l] >> (32 * half)) & 0xFFFFFFFF;
+            }
+
+            for (int i = half; i < m_width; ++i)
+            {
+                for (int l = 0; l < LANES; ++l)
+                {
+                    Wide sum = (Wide)a.limb[i - half][l] * factor[l] + r.limb[i][l] + carry[l];
+
+                    r.limb[i][l] = (Limb)sum;
+                    carry[l] = sum >> 32;
+                }
+            }
+        }
+    }
+};
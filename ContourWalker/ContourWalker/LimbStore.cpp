@@ -0,0 +1 @@
+#include "LimbStore.h"
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------
+// Where VLUIntN keeps its limbs. LimbStore<N> is a plain array of N limbs and throws
+// std::overflow_error if asked to hold more. LimbStore<0> has no limit: up to INLINE_LEN limbs
+// live in place, past that they move to a block from LimbPool that doubles as it needs to. Small
+// numbers then cost no more than a VLUIntN<4>, and big ones only copy the limbs they use.
+//
+// Limbs from the length the owner is using up to Capacity() are always 0.
+//
+// LimbBuffer is the same idea for working space, a stack array if SIZE is fixed or a pool block.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+typedef uint32_t VLLimb;
+
+//-------------------------------------------------------------------------------------------------
+// Free lists of limb blocks, one per power of 2 size and per thread, so that the temporaries of a
+// walk reuse the same few blocks rather than going to the heap on every operation.
+//-------------------------------------------------------------------------------------------------
+class LimbPool
+{
+    static const int MIN_SHIFT = 3;         // Smallest block, 8 limbs
+    static const int CLASSES = 24;          // Largest block, 2^26 limbs
+    static const size_t MAX_FREE = 64;      // Blocks kept per size, the rest go back to the heap
+
+    struct FreeLists
+    {
+        std::vector<VLLimb*> free[CLASSES];
+
+        ~FreeLists()
+        {
+            Closed() = true;
+
+            for (auto& list : free)
+            {
+                for (auto block : list)
+                {
+                    delete[] block;
+                }
+            }
+        }
+    };
+    //--------------------------------------------------------------------------------------------
+    // Set once the thread's lists are gone, anything freed after that (statics destroyed at exit)
+    // goes straight back to the heap
+    inline static bool& Closed()
+    {
+        thread_local bool closed = false;
+        return closed;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline static FreeLists& Lists()
+    {
+        thread_local FreeLists lists;
+        return lists;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline static int SizeClass(int len)
+    {
+        int k = 0;
+
+        while (k < CLASSES && (1 << (k + MIN_SHIFT)) < len)
+        {
+            ++k;
+        }
+
+        if (k == CLASSES)
+        {
+            throw std::overflow_error("VLUInt overflow");
+        }
+        return k;
+    }
+
+public:
+
+    //--------------------------------------------------------------------------------------------
+    // A block of at least len limbs, all 0, capacity is set to its actual size
+    inline static VLLimb* Allocate(int len, int& capacity)
+    {
+        int k = SizeClass(len);
+        VLLimb* block;
+
+        capacity = 1 << (k + MIN_SHIFT);
+
+        if (Closed() || Lists().free[k].empty())
+        {
+            block = new VLLimb[capacity];
+        }
+        else
+        {
+            block = Lists().free[k].back();
+            Lists().free[k].pop_back();
+        }
+
+        ::memset(block, 0, capacity * sizeof(VLLimb));
+        return block;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline static void Release(VLLimb* block, int capacity)
+    {
+        if (! Closed() && Lists().free[SizeClass(capacity)].size() < MAX_FREE)
+        {
+            Lists().free[SizeClass(capacity)].push_back(block);
+        }
+        else
+        {
+            delete[] block;
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+template <int N>
+class LimbStore
+{
+    VLLimb limbs[N]{ 0 };
+
+public:
+
+    static const bool GROWS = false;
+
+    inline operator VLLimb* () { return limbs; }
+    inline operator const VLLimb* () const { return limbs; }
+
+    inline int Capacity() const { return N; }
+
+    //--------------------------------------------------------------------------------------------
+    inline void Reserve(int len)
+    {
+        if (len > N)
+        {
+            throw std::overflow_error("VLUInt overflow");
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Copies the limbs of other, which is using len of them, over these, which were using old_len.
+    // A whole small array copies faster than a part of one.
+    inline void Assign(const LimbStore& other, int /*len*/, int /*old_len*/)
+    {
+        ::memcpy(limbs, other.limbs, sizeof(limbs));
+    }
+    //--------------------------------------------------------------------------------------------
+    // Moves other's limbs here if it can, returns true if it did and other is now empty
+    inline bool Take(LimbStore& other, int len, int old_len)
+    {
+        Assign(other, len, old_len);
+        return false;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline void Clear(int /*old_len*/)
+    {
+        ::memset(limbs, 0, sizeof(limbs));
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+template <>
+class LimbStore<0>
+{
+public:
+
+    static const int INLINE_LEN = 4;
+    static const bool GROWS = true;
+
+private:
+
+    VLLimb* limbs;
+    int capacity{ INLINE_LEN };
+    VLLimb inline_limbs[INLINE_LEN]{ 0 };
+
+    //--------------------------------------------------------------------------------------------
+    inline bool OnHeap() const { return limbs != inline_limbs; }
+
+    //--------------------------------------------------------------------------------------------
+    void Grow(int len)
+    {
+        int new_capacity;
+        auto block = LimbPool::Allocate(std::max(len, 2 * capacity), new_capacity);
+
+        ::memcpy(block, limbs, capacity * sizeof(VLLimb));
+
+        if (OnHeap())
+        {
+            LimbPool::Release(limbs, capacity);
+        }
+        else
+        {
+            ::memset(inline_limbs, 0, sizeof(inline_limbs));
+        }
+
+        limbs = block;
+        capacity = new_capacity;
+    }
+
+public:
+
+    inline LimbStore() : limbs(inline_limbs) {}
+
+    inline ~LimbStore()
+    {
+        if (OnHeap())
+        {
+            LimbPool::Release(limbs, capacity);
+        }
+    }
+
+    // VLUIntN copies with Assign, which knows how many limbs are in use
+
+    LimbStore(const LimbStore&) = delete;
+    LimbStore& operator = (const LimbStore&) = delete;
+
+    inline operator VLLimb* () { return limbs; }
+    inline operator const VLLimb* () const { return limbs; }
+
+    inline int Capacity() const { return capacity; }
+
+    //--------------------------------------------------------------------------------------------
+    inline void Reserve(int len)
+    {
+        if (len > capacity)
+        {
+            Grow(len);
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    inline void Assign(const LimbStore& other, int len, int old_len)
+    {
+        Reserve(len);
+        ::memcpy(limbs, other.limbs, len * sizeof(VLLimb));
+
+        if (old_len > len)
+        {
+            ::memset(limbs + len, 0, (old_len - len) * sizeof(VLLimb));
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    inline bool Take(LimbStore& other, int len, int old_len)
+    {
+        if (! other.OnHeap())
+        {
+            Assign(other, len, old_len);
+            return false;
+        }
+
+        if (OnHeap())
+        {
+            LimbPool::Release(limbs, capacity);
+        }
+        else
+        {
+            ::memset(inline_limbs, 0, sizeof(inline_limbs));
+        }
+
+        limbs = other.limbs;
+        capacity = other.capacity;
+        other.limbs = other.inline_limbs;
+        other.capacity = INLINE_LEN;
+
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline void Clear(int old_len)
+    {
+        ::memset(limbs, 0, old_len * sizeof(VLLimb));
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+template <int SIZE>
+class LimbBuffer
+{
+    VLLimb limbs[SIZE];
+
+public:
+
+    inline explicit LimbBuffer(int /*len*/) {}
+
+    inline operator VLLimb* () { return limbs; }
+};
+
+//-------------------------------------------------------------------------------------------------
+template <>
+class LimbBuffer<0>
+{
+    VLLimb* limbs;
+    int capacity;
+
+public:
+
+    // Comes from the pool already zeroed
+    inline explicit LimbBuffer(int len) : limbs(LimbPool::Allocate(len, capacity)) {}
+
+    inline ~LimbBuffer()
+    {
+        LimbPool::Release(limbs, capacity);
+    }
+
+    LimbBuffer(const LimbBuffer&) = delete;
+    LimbBuffer& operator = (const LimbBuffer&) = delete;
+
+    inline operator VLLimb* () { return limbs; }
+};
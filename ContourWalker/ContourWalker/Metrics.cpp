@@ -0,0 +1 @@
+#include "Metrics.h"
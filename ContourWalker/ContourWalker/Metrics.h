@@ -0,0 +1,333 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <cstdio>
+
+#include "Platform.h"
+
+//-------------------------------------------------------------------------------------------------
+// Counters for the walkers' hot paths, and a thread that appends a snapshot of them to a file
+// every few seconds, one line of JSON each, so throughput can be followed without a profiler.
+//
+// Each walker counts into its own WalkCounters, plain integers that only the thread walking it
+// touches, and publishes a copy to its Slot at the end of every chunk. The snapshot adds up the
+// slots, including those of walkers that have finished, and works out the steps (rows) per second
+// and ns per step since the snapshot before.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+struct WalkCounters
+{
+    static const int BUCKETS = 16;
+
+    __int64 rows{ 0 };                  // Steps up, one per row
+    __int64 x_steps{ 0 };               // Single steps along the rows, including the gallops
+    __int64 hops{ 0 };
+    __int64 hop_max_changes{ 0 };
+    __int64 results{ 0 };
+    __int64 hop_sizes[BUCKETS]{};       // Hops of 2^i to 2^(i + 1) - 1, the last bucket takes the rest
+    __int64 value_limbs[BUCKETS]{};     // 32 bit limbs in |value| and dv, sampled once a chunk
+    __int64 dv_limbs[BUCKETS]{};
+
+    // The hop only changes with hop_max, so the hops go into hop_sizes a run of the same size
+    // at a time
+
+    __int64 hop_size{ 0 };
+    __int64 hops_sized{ 0 };            // Hops in hop_sizes
+
+    //--------------------------------------------------------------------------------------------
+    // count hops of size
+    inline void Hop(__int64 size, __int64 count = 1)
+    {
+        if (size != hop_size)
+        {
+            Sized();
+            hop_size = size;
+        }
+
+        hops += count;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Brings hop_sizes up to date
+    inline void Sized()
+    {
+        hop_sizes[Bucket(hop_size)] += hops - hops_sized;
+        hops_sized = hops;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline void Limbs(int value, int dv)
+    {
+        ++value_limbs[(value < BUCKETS) ? value : BUCKETS - 1];
+        ++dv_limbs[(dv < BUCKETS) ? dv : BUCKETS - 1];
+    }
+    //--------------------------------------------------------------------------------------------
+    // floor(log2(n)), at most BUCKETS - 1
+    inline static int Bucket(__int64 n)
+    {
+        int bucket = 0;
+
+        while (n > 1 && bucket < BUCKETS - 1)
+        {
+            n >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+    //--------------------------------------------------------------------------------------------
+    WalkCounters& operator += (const WalkCounters& other)
+    {
+        rows += other.rows;
+        x_steps += other.x_steps;
+        hops += other.hops;
+        hop_max_changes += other.hop_max_changes;
+        results += other.results;
+
+        for (int i = 0; i < BUCKETS; ++i)
+        {
+            hop_sizes[i] += other.hop_sizes[i];
+            value_limbs[i] += other.value_limbs[i];
+            dv_limbs[i] += other.dv_limbs[i];
+        }
+        return *this;
+    }
+};
+
+class Metrics
+{
+public:
+
+    // A walker's counters as it last published them
+
+    class Slot
+    {
+        std::mutex m_lock;
+        WalkCounters m_counters;
+
+    public:
+
+        inline void Publish(const WalkCounters& counters)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_counters = counters;
+        }
+        //--------------------------------------------------------------------------------------------
+        inline WalkCounters Read()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_counters;
+        }
+    };
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    std::string m_file_name;
+    std::chrono::seconds m_interval;
+    std::thread m_thread;
+    std::mutex m_lock;                  // For the slots and the stop flag
+    std::condition_variable m_wake;
+    bool m_stop{ false };
+    std::deque<std::unique_ptr<Slot>> m_slots;
+    Clock::time_point m_start;
+    Clock::time_point m_last;           // The last snapshot
+    __int64 m_last_rows{ 0 };
+
+public:
+
+    Metrics(const std::string& file_name, int seconds)
+        : m_file_name (file_name)
+        , m_interval (seconds)
+        , m_start (Clock::now())
+        , m_last (m_start)
+    {
+        m_thread = std::thread(&Metrics::Run, this);
+    }
+    //--------------------------------------------------------------------------------------------
+    ~Metrics()
+    {
+        Close();
+    }
+    //--------------------------------------------------------------------------------------------
+    // A slot for a new walker, it lasts as long as this does
+    Slot * NewSlot()
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        m_slots.emplace_back(new Slot());
+        return m_slots.back().get();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Writes a last snapshot and stops the thread
+    void Close()
+    {
+        if (m_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            m_thread.join();
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Snapshots every seconds to file_name, until Stop
+    static void Start(const std::string& file_name, int seconds)
+    {
+        Instance().reset(new Metrics(file_name, seconds));
+    }
+    //--------------------------------------------------------------------------------------------
+    static void Stop()
+    {
+        Instance().reset();
+    }
+    //--------------------------------------------------------------------------------------------
+    // A slot from the running metrics, nullptr if there aren't any. Walkers register on their
+    // first chunk, between Start and Stop.
+    static Slot * Register()
+    {
+        auto& metrics = Instance();
+
+        return metrics ? metrics->NewSlot() : nullptr;
+    }
+
+    //=========================================================================================================
+    // Testing
+    //=========================================================================================================
+    // The snapshot adds up the slots
+    inline static void Test()
+    {
+        std::string file_name = "metrics_test.jsonl";
+
+        std::remove(file_name.c_str());
+
+        {
+            Metrics metrics(file_name, 3600);
+            WalkCounters counters;
+
+            counters.rows = 1000;
+            counters.Hop(5, 10);
+            counters.Limbs(3, 2);
+            counters.Sized();
+
+            metrics.NewSlot()->Publish(counters);
+            metrics.NewSlot()->Publish(counters);
+        }
+
+        std::ifstream file(file_name);
+        std::string line;
+        std::getline(file, line);
+        file.close();
+        std::remove(file_name.c_str());
+
+        for (auto expected : { "\"walkers\": 2,", "\"rows\": 2000,", "\"hops\": 20,", "\"hop_sizes\": [0, 0, 20, 0,", "\"value_limbs\": [0, 0, 0, 2," })
+        {
+            if (line.find(expected) == std::string::npos)
+            {
+                std::stringstream sstrm;
+                sstrm << "Metrics test: expected " << expected << " in " << line;
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+        }
+
+        // Finished
+
+        std::cout << "Metrics: All tests passed." << std::endl;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    void Run()
+    {
+        std::unique_lock<std::mutex> guard(m_lock);
+
+        for (;;)
+        {
+            bool stopping = m_wake.wait_for(guard, m_interval, [this]() { return m_stop; });
+
+            guard.unlock();
+            Snapshot();
+            guard.lock();
+
+            if (stopping)
+            {
+                return;
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Appends the totals as a line of JSON
+    void Snapshot()
+    {
+        WalkCounters total;
+        size_t walkers = 0;
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+
+            for (auto& slot : m_slots)
+            {
+                total += slot->Read();
+            }
+            walkers = m_slots.size();
+        }
+
+        auto now = Clock::now();
+        double seconds = std::chrono::duration<double>(now - m_last).count();
+        __int64 rows = total.rows - m_last_rows;
+
+        m_last = now;
+        m_last_rows = total.rows;
+
+        std::stringstream sstrm;
+        auto array = [&sstrm](const char * name, const __int64 * values)
+        {
+            sstrm << ", \"" << name << "\": [";
+
+            for (int i = 0; i < WalkCounters::BUCKETS; ++i)
+            {
+                sstrm << (i ? ", " : "") << values[i];
+            }
+            sstrm << "]";
+        };
+
+        sstrm << "{\"seconds\": " << std::chrono::duration<double>(now - m_start).count()
+              << ", \"walkers\": " << walkers
+              << ", \"rows\": " << total.rows
+              << ", \"x_steps\": " << total.x_steps
+              << ", \"hops\": " << total.hops
+              << ", \"hop_max_changes\": " << total.hop_max_changes
+              << ", \"results\": " << total.results
+              << ", \"steps_per_second\": " << ((seconds > 0) ? rows / seconds : 0.0)
+              << ", \"ns_per_step\": " << ((rows > 0) ? seconds * 1e9 / rows : 0.0);
+
+        array("hop_sizes", total.hop_sizes);
+        array("value_limbs", total.value_limbs);
+        array("dv_limbs", total.dv_limbs);
+
+        sstrm << "}";
+
+        std::ofstream file(m_file_name, std::ios_base::app);
+        file << sstrm.str() << std::endl;
+    }
+    //--------------------------------------------------------------------------------------------
+    static std::unique_ptr<Metrics>& Instance()
+    {
+        static std::unique_ptr<Metrics> instance;
+        return instance;
+    }
+};
@@ -0,0 +1 @@
+#include "MultiplyBenchmark.h"
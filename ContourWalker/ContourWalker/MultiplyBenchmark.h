@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#include "VLUInt.h"
+
+//-------------------------------------------------------------------------------------------------
+// Times the VLUInt multiplication kernels over a range of operand sizes: the old schoolbook
+// product, Comba, Comba squaring and Karatsuba (forced, whatever the size). Where Karatsuba
+// overtakes Comba is where VLUIntN::KARATSUBA_LIMBS should be.
+//
+// Uses a 128 limb VLUIntN so that the products of the bigger operands still fit.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+class MultiplyBenchmark
+{
+    typedef VLUIntN<128> Wide;
+    typedef Wide::Limb Limb;
+
+public:
+
+    inline static void Run()
+    {
+        static const int sizes[] = { 2, 4, 8, 13, 16, 24, 32, 48, 64 };
+
+        std::cout << "Multiply benchmark, ns per product" << std::endl;
+        std::cout << std::setw(8) << "limbs" << std::setw(12) << "schoolbook" << std::setw(12) << "comba"
+                  << std::setw(12) << "square" << std::setw(12) << "karatsuba" << std::endl;
+
+        uint64_t seed = 88172645463325252ULL;
+
+        for (int n : sizes)
+        {
+            auto a = Wide::Random(n, seed);
+            auto b = Wide::Random(n, seed);
+            int reps = 2000000 / (n * n) + 10;
+            Limb r[2 * 128];
+            Limb scratch[Wide::KaratsubaScratch(128) + 1];
+            Limb sink = 0;
+
+            auto schoolbook = Time(reps, [&]() { sink += a.MulSchoolbook(b).value[0]; });
+            auto comba = Time(reps, [&]() { Wide::MulComba(a.value, n, b.value, n, r); sink += r[0]; });
+            auto square = Time(reps, [&]() { Wide::SquareComba(a.value, n, r); sink += r[0]; });
+            auto karatsuba = (n < 4) ? 0.0 : Time(reps, [&]() { Karatsuba(a.value, b.value, n, r, scratch); sink += r[0]; });
+
+            std::cout << std::fixed << std::setprecision(0) << std::setw(8) << n << std::setw(12) << schoolbook
+                      << std::setw(12) << comba << std::setw(12) << square << std::setw(12) << karatsuba
+                      << ((sink == 1) ? " " : "") << std::endl;
+        }
+        std::cout.unsetf(std::ios_base::floatfield);
+        std::cout << "(Karatsuba is used from " << Wide::KARATSUBA_LIMBS << " limbs)" << std::endl;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    // One level of Karatsuba whatever the size, with Comba (or Karatsuba above the threshold)
+    // underneath, as MulKaratsuba would do if the threshold were n
+    static void Karatsuba(const Limb * a, const Limb * b, int n, Limb * r, Limb * scratch)
+    {
+        int m = n / 2;
+        int h = n - m;
+
+        Limb * sa = scratch;
+        Limb * sb = sa + h + 1;
+        Limb * z1 = sb + h + 1;
+        Limb * next = z1 + 2 * h + 2;
+
+        ::memcpy(sa, a + m, h * sizeof(Limb));
+        sa[h] = Wide::AddLimbs(sa, h, a, m);
+        ::memcpy(sb, b + m, h * sizeof(Limb));
+        sb[h] = Wide::AddLimbs(sb, h, b, m);
+
+        Wide::MulKaratsuba(a, b, m, r, next);
+        Wide::MulKaratsuba(a + m, b + m, h, r + 2 * m, next);
+        Wide::MulKaratsuba(sa, sb, h + 1, z1, next);
+
+        Wide::SubLimbs(z1, 2 * h + 2, r, 2 * m);
+        Wide::SubLimbs(z1, 2 * h + 2, r + 2 * m, 2 * h);
+        Wide::AddLimbs(r + m, 2 * n - m, z1, std::min(2 * h + 2, 2 * n - m));
+    }
+    //--------------------------------------------------------------------------------------------
+    // Nanoseconds per call
+    template <class Fn>
+    static double Time(int reps, Fn fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < reps; ++i)
+        {
+            fn();
+        }
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / reps;
+    }
+};
@@ -0,0 +1 @@
+#include "ParallelWalker.h"
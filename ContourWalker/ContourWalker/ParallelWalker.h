@@ -0,0 +1,229 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TieredWalker.h"
+
+//-------------------------------------------------------------------------------------------------
+// Walks one contour from start_x up to end_x on several threads. The x range is split into segments, each
+// segment is walked by its own TieredWalker started at the segment's first row (see
+// ContourPointT::SeekTo). Each segment hands over its results a chunk at a time, and they are
+// reported in x order: as they come for the lowest segment still walking, the ones above it wait
+// until it has finished.
+//
+// The walk costs about the same for each row (y), and y grows like x^(2/3), so the segments are
+// equal steps in x^(2/3) rather than in x.
+//
+// Int is the big integer type and Point the point template (ContourPointT or DeltaPointT), as
+// for ContourWalkerT.
+//-------------------------------------------------------------------------------------------------
+
+template <class Int, template <class> class Point>
+class ParallelWalkerT
+{
+    __int64 m_contour;
+    VLInt m_end_x;
+    std::vector<VLInt> m_starts;    // First x of each segment, 0 for the usual start
+    __int64 m_chunk;
+    std::string m_result_file{ "results.txt" };
+
+    // What a segment has handed over, guarded by m_lock
+
+    struct Segment
+    {
+        std::vector<Result> found;      // Not yet reported
+        VLInt reached;                  // How far it got, once done
+        std::string error;
+        bool done{ false };
+    };
+
+    std::mutex m_lock;
+    std::condition_variable m_changed;
+    std::vector<Segment> m_segments;
+
+public:
+
+    // start_x = 0 for the usual start
+
+    ParallelWalkerT(__int64 contour, const VLInt & start_x, __int64 chunk_size, const VLInt & end_x, int threads)
+        : m_contour (contour)
+        , m_end_x (end_x)
+        , m_starts (Split(contour, start_x, end_x, threads))
+        , m_chunk (chunk_size)
+    {
+    }
+    //--------------------------------------------------------------------------------------------
+    // The first x of each of (up to) count segments covering the walk from start_x up to end_x,
+    // the first one starts at start_x
+
+    inline static std::vector<VLInt> Split(__int64 contour, const VLInt & start_x, const VLInt & end_x, int count)
+    {
+        auto first = std::max(ContourPoint::StartX(contour), start_x);
+        std::vector<VLInt> starts = { start_x };
+
+        if (end_x <= first)
+        {
+            return starts;
+        }
+
+        double from = pow(ToDouble(first), 2.0 / 3.0);
+        double to = pow(ToDouble(end_x), 2.0 / 3.0);
+
+        for (int i = 1; i < count; ++i)
+        {
+            auto start = FromDouble(pow(from + (to - from) * i / count, 1.5));
+
+            if (start > first && start > starts.back() && start <= end_x)
+            {
+                starts.push_back(start);
+            }
+        }
+        return starts;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline size_t Segments() const
+    {
+        return m_starts.size();
+    }
+    //--------------------------------------------------------------------------------------------
+    void Walk()
+    {
+        m_segments.assign(m_starts.size(), Segment());
+
+        std::vector<std::thread> threads;
+
+        for (size_t i = 0; i < m_starts.size(); ++i)
+        {
+            threads.emplace_back(&ParallelWalkerT::WalkSegment, this, i);
+        }
+
+        auto& writer = ResultWriter::For(m_result_file);
+        WalkingResults merged;
+        std::string error;
+        std::stringstream sstrm;
+
+        sstrm << "Contour starting with " << ContourPoint::SeekTo(m_contour, m_starts[0]);
+        writer.Write(sstrm.str());
+
+        for (size_t i = 0; i < m_segments.size() && error.empty(); ++i)
+        {
+            bool done = false;
+            VLInt reached;
+
+            while (! done)
+            {
+                std::vector<Result> found;
+
+                {
+                    std::unique_lock<std::mutex> guard(m_lock);
+                    auto& segment = m_segments[i];
+
+                    m_changed.wait(guard, [&segment]() { return segment.done || ! segment.found.empty(); });
+                    found.swap(segment.found);
+                    done = segment.done;
+                    reached = segment.reached;
+                    error = segment.error;
+                }
+
+                // The segment walkers verified their results, only the new ones are written
+
+                for (auto& result : found)
+                {
+                    if (merged.Record(result))
+                    {
+                        writer.Write(result.ToString());
+                    }
+                }
+            }
+
+            if (error.empty())
+            {
+                std::cout << "Segment " << i << ", x = " << m_starts[i] << " to " << reached << std::endl;
+            }
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        if (! error.empty())
+        {
+            throw std::runtime_error(error.c_str());
+        }
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    inline VLInt SegmentEnd(size_t i) const
+    {
+        return (i + 1 < m_starts.size()) ? m_starts[i + 1] - 1 : m_end_x;
+    }
+    //--------------------------------------------------------------------------------------------
+    void WalkSegment(size_t i)
+    {
+        try
+        {
+            TieredWalkerT<Int, Point> walker(m_contour, m_starts[i], 0, m_chunk, SegmentEnd(i), true);
+
+            for (bool more = true; more; )
+            {
+                more = walker.Step();
+
+                auto found = walker.TakeResults();
+                std::lock_guard<std::mutex> guard(m_lock);
+                auto& segment = m_segments[i];
+
+                segment.found.insert(segment.found.end(), found.begin(), found.end());
+
+                if (! more)
+                {
+                    // Past the end once it has finished, short of it if interrupted
+
+                    auto x = walker.X();
+
+                    segment.reached = (x < SegmentEnd(i)) ? x : SegmentEnd(i);
+                    segment.done = true;
+                }
+
+                if (! found.empty() || segment.done)
+                {
+                    m_changed.notify_one();
+                }
+            }
+        }
+        catch (std::exception& ex)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+
+            m_segments[i].error = ex.what();
+            m_segments[i].done = true;
+            m_changed.notify_one();
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Only used to place the segment boundaries, which don't have to be exact
+    inline static double ToDouble(const VLInt & x)
+    {
+        auto me = x.MantissaExponent();
+
+        return me.first * pow(10, me.second);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline static VLInt FromDouble(double d)
+    {
+        int exponent = 0;
+
+        while (d >= 1e15)
+        {
+            d /= 10;
+            ++exponent;
+        }
+
+        return VLInt((__int64)d) * VLInt(10).Pow(exponent);
+    }
+};
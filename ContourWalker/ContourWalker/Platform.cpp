@@ -0,0 +1 @@
+#include "Platform.h"
@@ -0,0 +1,27 @@
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// What the code needs from the compiler that MSVC and GCC/Clang spell differently. The code is
+// written with MSVC's __int64, other compilers get it as long long (a macro rather than a typedef
+// so that unsigned __int64 still works).
+//
+// FORCE_INLINE is for the small helpers of the CPU specific kernels (see CpuDispatch), they have
+// to be inlined into each variant to be compiled for its instruction set.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _MSC_VER
+#ifndef __int64
+#define __int64 long long
+#endif
+#endif
+
+#ifdef _MSC_VER
+#define FORCE_INLINE __forceinline
+#elif defined(__GNUC__)
+#define FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define FORCE_INLINE inline
+#endif
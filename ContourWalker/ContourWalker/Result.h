@@ -6,6 +6,8 @@
 #include <iostream>
 
 #include "VLInt.h"
+#include "ResultIndex.h"
+#include "Trace.h"
 
 class Result
 {
@@ -36,6 +38,31 @@ public:
         return sstrm.str();
     }
 
+    //--------------------------------------------------------------------------------------------
+    // Key() as a hash, from the limbs with no strings
+    inline Fingerprint Print() const
+    {
+        Fingerprint print;
+
+        for (auto n : { &x, &y, &z })
+        {
+            auto length = n->value.Length();
+
+            while (length > 0 && n->value.GetLimb(length - 1) == 0)
+            {
+                --length;
+            }
+
+            print.Add(((uint64_t)length << 1) | (n->positive ? 0 : 1));
+
+            for (int i = 0; i < length; ++i)
+            {
+                print.Add(n->value.GetLimb(i));
+            }
+        }
+        return print;
+    }
+
     inline std::string ToString() const
     {
         std::stringstream sstrm;
@@ -50,6 +77,7 @@ public:
     //--------------------------------------------------------------------------------------------
     inline void VerifySolution() const
     {
+        Trace::Span span("VerifySolution");
         auto val = (x.Cube() + y.Cube() - z.Cube()).ToInt();
 
         if (flip)
@@ -60,7 +88,7 @@ public:
         {
             std::stringstream sstrm;
             sstrm << "Result: [" << (*this) << "], got " << val;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
     }
     //------------------------------------------------------------------------------------------------------
@@ -0,0 +1 @@
+#include "ResultIndex.h"
@@ -0,0 +1,387 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "Platform.h"
+
+//-------------------------------------------------------------------------------------------------
+// The set of results already seen, for WalkingResults to drop repeats. Results are kept as 128 bit
+// fingerprints of their (x, y, z) limbs (see Result::Print) in an open addressing table, 16
+// bytes each, which doubles until it would pass a memory limit. After that it either
+//
+//  - forgets what it holds and starts again. Repeats come from neighbouring rows, so all this
+//    costs is the odd repeat written twice. The default.
+//  - turns into a Bloom filter the size of the limit. This never forgets, but now and again takes
+//    a new result for a repeat and drops it (FalsePositiveRate is the estimate). For runs long
+//    enough to find more results than the limit holds.
+//
+// The limit and the choice are set for every index with SetDefaults (-m, --bloom).
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+struct Fingerprint
+{
+    uint64_t a{ 0 };
+    uint64_t b{ 0 };
+
+    //--------------------------------------------------------------------------------------------
+    // Mixes in a word, the two halves use different multipliers so they don't collide together
+    inline void Add(uint64_t word)
+    {
+        a = Mix(a ^ word, 0x9E3779B97F4A7C15ULL);
+        b = Mix(b ^ word, 0xC2B2AE3D27D4EB4FULL);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline bool operator == (const Fingerprint& other) const
+    {
+        return a == other.a && b == other.b;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline bool IsEmpty() const
+    {
+        return a == 0 && b == 0;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    inline static uint64_t Mix(uint64_t h, uint64_t multiplier)
+    {
+        h *= multiplier;
+        h ^= h >> 29;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        return h ^ (h >> 32);
+    }
+};
+
+class ResultIndex
+{
+    static const size_t MIN_SLOTS = 64;
+    static const int PROBES = 7;            // Bloom filter bits per result
+
+    std::vector<Fingerprint> m_table;
+    std::vector<uint64_t> m_bits;           // The Bloom filter, empty until the table is full
+    size_t m_max_bytes;
+    bool m_bloom;
+    __int64 m_count{ 0 };                   // In the table, or added to the filter
+    __int64 m_resets{ 0 };
+
+public:
+
+    ResultIndex()
+        : m_max_bytes (Defaults().max_bytes)
+        , m_bloom (Defaults().bloom)
+    {
+    }
+    //--------------------------------------------------------------------------------------------
+    ResultIndex(size_t max_bytes, bool bloom)
+        : m_max_bytes (max_bytes)
+        , m_bloom (bloom)
+    {
+    }
+    //--------------------------------------------------------------------------------------------
+    // Returns false if print was there already (or the Bloom filter thinks it was)
+    bool Insert(const Fingerprint& print)
+    {
+        auto key = Key(print);
+
+        if (! m_bits.empty())
+        {
+            return BloomInsert(key);
+        }
+
+        if (m_table.empty())
+        {
+            m_table.resize(MIN_SLOTS);
+        }
+
+        auto mask = m_table.size() - 1;
+
+        for (auto slot = key.a & mask; ; slot = (slot + 1) & mask)
+        {
+            if (m_table[slot] == key)
+            {
+                return false;
+            }
+            if (m_table[slot].IsEmpty())
+            {
+                break;
+            }
+        }
+
+        // New, at most 3/4 full
+
+        if ((size_t)(m_count + 1) * 4 > m_table.size() * 3)
+        {
+            if (m_table.size() * 2 * sizeof(Fingerprint) <= m_max_bytes)
+            {
+                Resize(m_table.size() * 2);
+            }
+            else if (m_bloom)
+            {
+                ToBloom();
+                return BloomInsert(key);
+            }
+            else
+            {
+                m_table.assign(m_table.size(), Fingerprint());
+                m_count = 0;
+                ++m_resets;
+            }
+        }
+
+        Place(key);
+        ++m_count;
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Whether Insert would return false, without adding it
+    bool Contains(const Fingerprint& print) const
+    {
+        auto key = Key(print);
+
+        if (! m_bits.empty())
+        {
+            auto mask = m_bits.size() * 64 - 1;
+            auto step = key.b | 1;
+
+            for (int i = 0; i < PROBES; ++i)
+            {
+                auto bit = (key.a + i * step) & mask;
+
+                if ((m_bits[bit / 64] & ((uint64_t)1 << (bit % 64))) == 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        if (m_table.empty())
+        {
+            return false;
+        }
+
+        auto mask = m_table.size() - 1;
+
+        for (auto slot = key.a & mask; ! m_table[slot].IsEmpty(); slot = (slot + 1) & mask)
+        {
+            if (m_table[slot] == key)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline size_t Bytes() const
+    {
+        return m_table.capacity() * sizeof(Fingerprint) + m_bits.capacity() * sizeof(uint64_t);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline __int64 Count() const { return m_count; }
+    inline __int64 Resets() const { return m_resets; }
+    inline bool IsBloom() const { return ! m_bits.empty(); }
+    //--------------------------------------------------------------------------------------------
+    // The chance that the Bloom filter takes a new result for a repeat, 0 for the table
+    inline double FalsePositiveRate() const
+    {
+        if (m_bits.empty())
+        {
+            return 0;
+        }
+
+        double bits = 64.0 * m_bits.size();
+
+        return std::pow(1 - std::exp(-PROBES * m_count / bits), PROBES);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Sets the limit and what happens at it for indexes created from now on
+    inline static void SetDefaults(size_t max_bytes, bool bloom)
+    {
+        Defaults().max_bytes = max_bytes;
+        Defaults().bloom = bloom;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline friend std::ostream& operator << (std::ostream& os, const ResultIndex& index)
+    {
+        os << index.m_count << " results in " << (index.Bytes() + 1023) / 1024 << " KB";
+
+        if (index.IsBloom())
+            os << ", Bloom filter, false positive rate " << index.FalsePositiveRate();
+        else if (index.m_resets > 0)
+            os << ", forgotten " << index.m_resets << " times";
+
+        return os;
+    }
+
+    //=========================================================================================================
+    // Testing
+    //=========================================================================================================
+    // Repeats are found while the table grows, once it is full it forgets or, as a Bloom filter,
+    // still knows everything it was given
+    inline static void Test()
+    {
+        const int count = 5000;
+        auto print = [](int i) { Fingerprint p; p.Add(i); return p; };
+
+        ResultIndex big(1 << 20, false);
+        ResultIndex small(4096, false);
+        ResultIndex bloom(4096, true);
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (! big.Insert(print(i)) || big.Insert(print(i)) || ! small.Insert(print(i)) || small.Insert(print(i)))
+            {
+                std::stringstream sstrm;
+                sstrm << "ResultIndex test: " << i << " not new the first time or new the second";
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+            bloom.Insert(print(i));
+        }
+
+        __int64 new_again = 0;
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (big.Insert(print(i)) || ! bloom.Contains(print(i)) || bloom.Insert(print(i)))
+            {
+                throw std::runtime_error("ResultIndex test: forgot a result");
+            }
+            new_again += small.Insert(print(i)) ? 1 : 0;
+        }
+
+        if (small.Resets() == 0 || new_again == 0 || small.Bytes() > 4096 || ! bloom.IsBloom() || bloom.Bytes() > 4096)
+        {
+            throw std::runtime_error("ResultIndex test: limit not applied");
+        }
+
+        // 5000 results in 32768 bits with 7 probes is about 5% false positives
+
+        int false_positives = 0;
+
+        for (int i = count; i < 2 * count; ++i)
+        {
+            false_positives += bloom.Contains(print(i)) ? 1 : 0;
+        }
+
+        if (false_positives > count / 10 || bloom.FalsePositiveRate() <= 0)
+        {
+            std::stringstream sstrm;
+            sstrm << "ResultIndex test: " << false_positives << " false positives from the Bloom filter";
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+
+        // Finished
+
+        std::cout << "ResultIndex: All tests passed." << std::endl;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    struct Settings
+    {
+        size_t max_bytes{ 64 << 20 };
+        bool bloom{ false };
+    };
+    //--------------------------------------------------------------------------------------------
+    inline static Settings& Defaults()
+    {
+        static Settings settings;
+        return settings;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Empty marks a free slot, so that one is stored as something else
+    inline static Fingerprint Key(const Fingerprint& print)
+    {
+        auto key = print;
+
+        if (key.IsEmpty())
+        {
+            key.b = 1;
+        }
+        return key;
+    }
+    //--------------------------------------------------------------------------------------------
+    // key is known not to be there
+    inline void Place(const Fingerprint& key)
+    {
+        auto mask = m_table.size() - 1;
+        auto slot = key.a & mask;
+
+        while (! m_table[slot].IsEmpty())
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_table[slot] = key;
+    }
+    //--------------------------------------------------------------------------------------------
+    void Resize(size_t slots)
+    {
+        std::vector<Fingerprint> old(slots);
+
+        old.swap(m_table);
+
+        for (auto& key : old)
+        {
+            if (! key.IsEmpty())
+            {
+                Place(key);
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Moves the table into a filter of m_max_bytes, a power of 2 bits
+    void ToBloom()
+    {
+        size_t words = 1;
+
+        while (words * 2 * sizeof(uint64_t) <= m_max_bytes)
+        {
+            words *= 2;
+        }
+
+        m_bits.assign(words, 0);
+        m_count = 0;
+
+        for (auto& key : m_table)
+        {
+            if (! key.IsEmpty())
+            {
+                BloomInsert(key);
+            }
+        }
+
+        std::vector<Fingerprint>().swap(m_table);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Bits a + i b for i < PROBES, new if any of them was clear. b is made odd so that the
+    // probes don't repeat.
+    bool BloomInsert(const Fingerprint& key)
+    {
+        auto mask = m_bits.size() * 64 - 1;
+        auto step = key.b | 1;
+        bool added = false;
+
+        for (int i = 0; i < PROBES; ++i)
+        {
+            auto bit = (key.a + i * step) & mask;
+            auto& word = m_bits[bit / 64];
+            uint64_t flag = (uint64_t)1 << (bit % 64);
+
+            added = added || (word & flag) == 0;
+            word |= flag;
+        }
+
+        m_count += added ? 1 : 0;
+        return added;
+    }
+};
@@ -0,0 +1 @@
+#include "ResultPipeline.h"
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Result.h"
+#include "SpscQueue.h"
+#include "WalkingResults.h"
+
+//-------------------------------------------------------------------------------------------------
+// Takes results off a walker's thread. The walker pushes each candidate onto a ring buffer and
+// carries on, a verifier thread checks it (three big cubes) and passes it on to a recorder thread,
+// which adds it to the walker's WalkingResults (the dedupe, and the key strings it needs) and
+// hands the new ones to the sink, usually a ResultWriter. Both queues are SpscQueues, a full one
+// makes its producer wait, so a walker that finds results faster than they can be checked slows
+// down rather than queueing without limit.
+//
+// Results are recorded in the order they were pushed. Drain waits for everything pushed so far,
+// the walker calls it before it reads its results (Save, taking over from another walker). A
+// result that fails its check is thrown on the walker's thread by the next Push or Drain.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+class ResultPipeline
+{
+public:
+
+    typedef std::function<void(const Result&)> Sink;
+
+private:
+
+    WalkingResults& m_results;
+    Sink m_sink;
+    SpscQueue<Result> m_candidates;         // Walker to verifier
+    SpscQueue<Result> m_verified;           // Verifier to recorder
+    std::thread m_verifier;
+    std::thread m_recorder;
+    std::atomic<bool> m_stop{ false };
+    std::atomic<bool> m_verifier_done{ false };
+    std::atomic<bool> m_failed{ false };
+    std::atomic<__int64> m_done{ 0 };       // Candidates recorded, or dropped by the verifier
+    __int64 m_pushed{ 0 };                  // Walker's thread only
+    std::mutex m_error_lock;
+    std::string m_error;
+
+public:
+
+    ResultPipeline(WalkingResults& results, Sink sink, size_t capacity = 1024)
+        : m_results (results)
+        , m_sink (sink)
+        , m_candidates (capacity)
+        , m_verified (capacity)
+    {
+        m_verifier = std::thread(&ResultPipeline::Verify, this);
+        m_recorder = std::thread(&ResultPipeline::Record, this);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Records whatever is queued and stops the threads
+    ~ResultPipeline()
+    {
+        m_stop = true;
+        m_verifier.join();
+        m_recorder.join();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Only waits if the verifier is behind by a full queue
+    void Push(Result candidate)
+    {
+        ThrowIfFailed();
+
+        while (! m_candidates.TryPush(candidate))
+        {
+            std::this_thread::yield();
+        }
+        ++m_pushed;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Waits until every candidate pushed so far is in the results and passed to the sink
+    void Drain()
+    {
+        while (m_done.load(std::memory_order_acquire) < m_pushed && ! m_failed)
+        {
+            std::this_thread::yield();
+        }
+
+        ThrowIfFailed();
+    }
+
+    //=========================================================================================================
+    // Testing
+    //=========================================================================================================
+    // Small sums of cubes, each pushed twice, come out once each in the order pushed. A wrong one
+    // is thrown by Drain.
+    inline static void Test()
+    {
+        WalkingResults results;
+        std::vector<Result> sunk;
+        std::vector<Result> expected;
+
+        results.SetQuiet(true);
+        results.SetKeep(true);
+
+        {
+            ResultPipeline pipeline(results, [&sunk](const Result& r) { sunk.push_back(r); }, 4);
+
+            for (__int64 x = 1; x < 40; ++x)
+            {
+                for (__int64 y = x; y < 40; ++y)
+                {
+                    __int64 z = y;
+
+                    while ((z + 1) * (z + 1) * (z + 1) <= x * x * x + y * y * y)
+                    {
+                        ++z;
+                    }
+
+                    Result r(VLInt(x), VLInt(y), VLInt(z), VLInt(x * x * x + y * y * y - z * z * z));
+
+                    expected.push_back(r);
+                    pipeline.Push(r);
+                    pipeline.Push(r);
+                }
+            }
+
+            pipeline.Drain();
+
+            bool same = sunk.size() == expected.size() && results.Found().size() == expected.size();
+
+            for (size_t i = 0; same && i < expected.size(); ++i)
+            {
+                same = sunk[i].Key() == expected[i].Key() && results.Found()[i].Key() == expected[i].Key();
+            }
+
+            if (! same)
+            {
+                std::stringstream sstrm;
+                sstrm << "ResultPipeline test: recorded " << results.Found().size() << " and sank " << sunk.size() << ", expected " << expected.size();
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+
+            pipeline.Push(Result(VLInt(2), VLInt(3), VLInt(3), VLInt(7)));
+
+            bool thrown = false;
+
+            try
+            {
+                pipeline.Drain();
+            }
+            catch (std::exception&)
+            {
+                thrown = true;
+            }
+
+            if (! thrown)
+            {
+                throw std::runtime_error("ResultPipeline test: a wrong result got through");
+            }
+        }
+
+        // Finished
+
+        std::cout << "ResultPipeline: All tests passed." << std::endl;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    void ThrowIfFailed()
+    {
+        if (m_failed)
+        {
+            std::lock_guard<std::mutex> guard(m_error_lock);
+
+            throw std::runtime_error(m_error.c_str());
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // The verifier thread
+    void Verify()
+    {
+        Result candidate;
+
+        for (;;)
+        {
+            // Read the stop flag first, anything pushed before it was set is then picked up below
+
+            bool stopping = m_stop;
+            bool any = false;
+
+            while (m_candidates.TryPop(candidate))
+            {
+                any = true;
+
+                try
+                {
+                    candidate.VerifySolution();
+                }
+                catch (std::exception& ex)
+                {
+                    Fail(ex.what());
+                    ++m_done;
+                    continue;
+                }
+
+                while (! m_verified.TryPush(candidate))
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            if (stopping)
+            {
+                break;
+            }
+
+            if (! any)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        m_verifier_done = true;
+    }
+    //--------------------------------------------------------------------------------------------
+    // The recorder thread
+    void Record()
+    {
+        Result result;
+
+        for (;;)
+        {
+            bool stopping = m_verifier_done;
+            bool any = false;
+
+            while (m_verified.TryPop(result))
+            {
+                any = true;
+
+                try
+                {
+                    if (m_results.Record(result))
+                    {
+                        m_sink(result);
+                    }
+                }
+                catch (std::exception& ex)
+                {
+                    Fail(ex.what());
+                }
+
+                m_done.fetch_add(1, std::memory_order_release);
+            }
+
+            if (stopping)
+            {
+                break;
+            }
+
+            if (! any)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Keeps the first error
+    void Fail(const std::string& error)
+    {
+        std::lock_guard<std::mutex> guard(m_error_lock);
+
+        if (! m_failed)
+        {
+            m_error = error;
+            m_failed = true;
+        }
+    }
+};
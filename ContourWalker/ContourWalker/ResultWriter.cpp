@@ -0,0 +1 @@
+#include "ResultWriter.h"
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "BoundedQueue.h"
+#include "Trace.h"
+
+//-------------------------------------------------------------------------------------------------
+// Appends lines to a results file from a background thread. Walkers push lines onto a lock free
+// queue and carry on, the writer thread collects them and writes them in batches, once there is
+// flush_bytes waiting or flush_ms has passed since the last write. Close (or CloseAll) writes
+// whatever is left and closes the file, Flush writes whatever is queued and waits for it.
+//
+// Ctrl-C and SIGTERM set the Interrupted flag, the walkers stop at the end of their current chunk
+// and main closes the writers as usual, so nothing found is lost.
+//
+// There is one writer per file name, For() returns it.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+class ResultWriter
+{
+    std::string m_file_name;
+    BoundedQueue<std::string> m_queue;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{ false };
+    std::atomic<size_t> m_pushed{ 0 };      // Lines queued
+    std::atomic<size_t> m_written{ 0 };     // Lines in the file
+    std::atomic<size_t> m_flush_to{ 0 };    // Flush waits for m_written to get here
+    size_t m_flush_bytes;
+    std::chrono::milliseconds m_flush_interval;
+
+public:
+
+    ResultWriter(const std::string& file_name, size_t flush_bytes = 1 << 16, int flush_ms = 1000, size_t capacity = 4096)
+        : m_file_name (file_name)
+        , m_queue (capacity)
+        , m_flush_bytes (flush_bytes)
+        , m_flush_interval (flush_ms)
+    {
+        m_thread = std::thread(&ResultWriter::Run, this);
+    }
+    //--------------------------------------------------------------------------------------------
+    ~ResultWriter()
+    {
+        Close();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Only waits if the queue is full
+    void Write(std::string line)
+    {
+        Trace::Span span("Write");
+
+        while (! m_queue.TryPush(line))
+        {
+            std::this_thread::yield();
+        }
+        ++m_pushed;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Waits until every line written so far is in the file, used before taking a checkpoint
+    void Flush()
+    {
+        size_t target = m_pushed;
+
+        m_flush_to = target;
+
+        while (m_written < target && m_thread.joinable())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Writes everything queued so far and stops the writer thread
+    void Close()
+    {
+        if (m_thread.joinable())
+        {
+            m_stop = true;
+            m_thread.join();
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // The writer for a file, created on first use
+    static ResultWriter& For(const std::string& file_name)
+    {
+        std::lock_guard<std::mutex> guard(Lock());
+        auto& writer = Writers()[file_name];
+
+        if (! writer)
+        {
+            writer.reset(new ResultWriter(file_name));
+        }
+        return *writer;
+    }
+    //--------------------------------------------------------------------------------------------
+    static void CloseAll()
+    {
+        std::lock_guard<std::mutex> guard(Lock());
+
+        Writers().clear();
+    }
+    //--------------------------------------------------------------------------------------------
+    static void FlushAll()
+    {
+        std::lock_guard<std::mutex> guard(Lock());
+
+        for (auto& writer : Writers())
+        {
+            writer.second->Flush();
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // A second signal gets the default handling, so a stuck walk can still be killed
+    static void InstallSignalHandlers()
+    {
+        InterruptFlag() = false;
+        signal(SIGINT, OnSignal);
+        signal(SIGTERM, OnSignal);
+    }
+    //--------------------------------------------------------------------------------------------
+    static bool Interrupted()
+    {
+        return InterruptFlag().load(std::memory_order_relaxed);
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    void Run()
+    {
+        std::ofstream file;
+        std::string buffer;
+        std::string line;
+        size_t lines = 0;
+        auto last_write = std::chrono::steady_clock::now();
+
+        file.open(m_file_name, std::ios_base::app);
+
+        for (;;)
+        {
+            // Read the stop flag first, anything queued before Close is then picked up below
+
+            bool stopping = m_stop;
+            bool flushing = m_written < m_flush_to;
+
+            while ((stopping || flushing || buffer.size() < m_flush_bytes) && m_queue.TryPop(line))
+            {
+                buffer += line;
+                buffer += '\n';
+                ++lines;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+
+            if (! buffer.empty() && (stopping || flushing || buffer.size() >= m_flush_bytes || now - last_write >= m_flush_interval))
+            {
+                Trace::Span span("write file");
+
+                file << buffer;
+                file.flush();
+                buffer.clear();
+                m_written += lines;
+                lines = 0;
+                last_write = now;
+            }
+
+            if (stopping)
+            {
+                break;
+            }
+
+            if (buffer.size() < m_flush_bytes)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        file.close();
+    }
+    //--------------------------------------------------------------------------------------------
+    static void OnSignal(int sig)
+    {
+        InterruptFlag() = true;
+        signal(sig, SIG_DFL);
+    }
+    //--------------------------------------------------------------------------------------------
+    static std::atomic<bool>& InterruptFlag()
+    {
+        static std::atomic<bool> flag{ false };
+        return flag;
+    }
+    //--------------------------------------------------------------------------------------------
+    static std::map<std::string, std::unique_ptr<ResultWriter>>& Writers()
+    {
+        static std::map<std::string, std::unique_ptr<ResultWriter>> writers;
+        return writers;
+    }
+    //--------------------------------------------------------------------------------------------
+    static std::mutex& Lock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+};
@@ -0,0 +1 @@
+#include "SpscQueue.h"
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "Platform.h"
+
+//-------------------------------------------------------------------------------------------------
+// A fixed size ring buffer for one producer thread and one consumer thread. Each side owns its
+// own index and only reads the other's when it looks full or empty, keeping a copy until then,
+// so a push or pop is usually a store and no shared cache lines. BoundedQueue is the one for
+// several producers or consumers.
+//
+// The size must be a power of 2.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+template <class T>
+class SpscQueue
+{
+    // Each side's index is a cache line away from anything else, by padding rather than alignas
+    // as new doesn't have to honour an over-aligned type before C++17
+
+    static const size_t CACHE_LINE = 64;
+
+    std::unique_ptr<T[]> m_cells;
+    size_t m_mask;
+
+    char m_pad_0[CACHE_LINE];
+    std::atomic<size_t> m_push{ 0 };
+    size_t m_pop_seen{ 0 };                 // The producer's copy of m_pop
+
+    char m_pad_1[CACHE_LINE];
+    std::atomic<size_t> m_pop{ 0 };
+    size_t m_push_seen{ 0 };                // The consumer's copy of m_push
+    char m_pad_2[CACHE_LINE];
+
+public:
+
+    SpscQueue(size_t size)
+        : m_cells (new T[size])
+        , m_mask (size - 1)
+    {
+        if (size < 2 || (size & m_mask) != 0)
+        {
+            throw std::runtime_error("SpscQueue size must be a power of 2");
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Producer only, returns false if the queue is full, value is only moved from if it succeeds
+    bool TryPush(T& value)
+    {
+        auto pos = m_push.load(std::memory_order_relaxed);
+
+        if (pos - m_pop_seen > m_mask)
+        {
+            m_pop_seen = m_pop.load(std::memory_order_acquire);
+
+            if (pos - m_pop_seen > m_mask)
+            {
+                return false;
+            }
+        }
+
+        m_cells[pos & m_mask] = std::move(value);
+        m_push.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Consumer only, returns false if the queue is empty
+    bool TryPop(T& value)
+    {
+        auto pos = m_pop.load(std::memory_order_relaxed);
+
+        if (pos == m_push_seen)
+        {
+            m_push_seen = m_push.load(std::memory_order_acquire);
+
+            if (pos == m_push_seen)
+            {
+                return false;
+            }
+        }
+
+        value = std::move(m_cells[pos & m_mask]);
+        m_pop.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    //=========================================================================================================
+    // Testing
+    //=========================================================================================================
+    // A producer and a consumer through a small queue, everything arrives once and in order
+    inline static void Test()
+    {
+        const int count = 200000;
+
+        SpscQueue<int> queue(64);
+
+        std::thread producer([&queue, count]()
+        {
+            for (int i = 1; i <= count; ++i)
+            {
+                int value = i;
+
+                while (! queue.TryPush(value))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        int expected = 1;
+
+        while (expected <= count)
+        {
+            int value;
+
+            if (! queue.TryPop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            if (value != expected)
+            {
+                producer.join();
+
+                std::stringstream sstrm;
+                sstrm << "SpscQueue test: got " << value << ", expected " << expected;
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+
+            ++expected;
+        }
+
+        producer.join();
+
+        int value;
+
+        if (queue.TryPop(value))
+        {
+            throw std::runtime_error("SpscQueue test: queue not empty");
+        }
+
+        // Finished
+
+        std::cout << "SpscQueue: All tests passed." << std::endl;
+    }
+};
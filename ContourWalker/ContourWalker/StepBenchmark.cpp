@@ -0,0 +1 @@
+#include "StepBenchmark.h"
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#include "ContourPoint.h"
+#include "DeltaPoint.h"
+
+//-------------------------------------------------------------------------------------------------
+// Compares two ways of walking the rows of a contour. "Copying" takes the steps the way FillNoDraw
+// used to, with GetNextX / GetNextY and prev = current on every step. "In place" uses
+// IncrementSub / IncrementCube and TestPreviousX, as FillNoDraw does now. Both hop the same way
+// and must end on the same point.
+//
+// Reports the time per row, and the bytes of VLUInt copied per row when built with
+// VLINT_COUNT_COPIES defined. Uses VLIntFixed, which is what the walker uses past native integers.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+class StepBenchmark
+{
+    typedef decltype(VLIntFixed::value) UInt;
+
+public:
+
+    inline static void Run(__int64 contour = 5, __int64 rows = 1000000)
+    {
+        std::cout << "Step benchmark, contour " << contour << ", " << rows << " rows" << std::endl;
+
+#ifndef VLINT_COUNT_COPIES
+        std::cout << "(build with VLINT_COUNT_COPIES defined to count the bytes copied)" << std::endl;
+#endif
+        Measure<ContourPointT<VLIntFixed>>("ContourPoint", contour, rows);
+        Measure<DeltaPointT<VLIntFixed>>("DeltaPoint", contour, rows);
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    template <class Point>
+    static void Measure(const char * name, __int64 contour, __int64 rows)
+    {
+        Point copying(contour);
+        Point in_place(contour);
+        int tests = 0;
+
+        auto copying_bytes = UInt::CopiedBytes();
+        auto copying_time = Time([&]() { tests += CopyingRows(copying, rows); });
+
+        copying_bytes = UInt::CopiedBytes() - copying_bytes;
+
+        auto in_place_bytes = UInt::CopiedBytes();
+        auto in_place_time = Time([&]() { tests -= InPlaceRows(in_place, rows); });
+
+        in_place_bytes = UInt::CopiedBytes() - in_place_bytes;
+
+        if (VLInt(copying.X()) != VLInt(in_place.X()) || VLInt(copying.Y()) != VLInt(in_place.Y()) || tests != 0)
+        {
+            throw std::runtime_error("Step benchmark: the two walks disagree");
+        }
+
+        Report(name, "copying", copying_time, copying_bytes, rows);
+        Report(name, "in place", in_place_time, in_place_bytes, rows);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Returns the number of small values seen, so that the tests can't be optimised away
+    template <class Point>
+    static int CopyingRows(Point& current, __int64 rows)
+    {
+        int found = 0;
+        __int64 hop = 0;
+
+        for (__int64 row = 0; row < rows; ++row)
+        {
+            auto start = current.X();
+
+            if (hop >= 2)
+            {
+                current.HopSub(hop);
+            }
+
+            auto prev = current;
+
+            while (current.IsPositive())
+            {
+                prev = current;
+                current = current.GetNextX();
+            }
+
+            auto v2 = current.GetNextY();
+
+            found += prev.TestValue() + current.TestValue() + v2.TestValue();
+            current = v2;
+            hop = (current.X() - start).ToInt() - 2;
+        }
+        return found;
+    }
+    //--------------------------------------------------------------------------------------------
+    template <class Point>
+    static int InPlaceRows(Point& current, __int64 rows)
+    {
+        int found = 0;
+        __int64 hop = 0;
+
+        for (__int64 row = 0; row < rows; ++row)
+        {
+            auto start = current.X();
+            bool moved = false;
+
+            if (hop >= 2)
+            {
+                current.HopSub(hop);
+            }
+
+            while (current.IsPositive())
+            {
+                current.IncrementSub();
+                moved = true;
+            }
+
+            found += (moved ? current.TestPreviousX() : current.TestValue()) + current.TestValue();
+            current.IncrementCube();
+            found += current.TestValue();
+            hop = (current.X() - start).ToInt() - 2;
+        }
+        return found;
+    }
+    //--------------------------------------------------------------------------------------------
+    template <class Fn>
+    static double Time(Fn fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        fn();
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    //--------------------------------------------------------------------------------------------
+    static void Report(const char * name, const char * how, double seconds, __int64 bytes, __int64 rows)
+    {
+        std::cout << "  " << std::setw(14) << std::left << name << std::setw(9) << how << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(8) << seconds * 1e9 / rows << " ns/row";
+#ifdef VLINT_COUNT_COPIES
+        std::cout << std::setw(10) << (double)bytes / rows << " bytes copied/row";
+#else
+        (void) bytes;
+#endif
+        std::cout << std::endl;
+        std::cout.unsetf(std::ios_base::floatfield);
+    }
+};
@@ -6,63 +6,84 @@
 #include <iostream>
 
 #include "VLInt.h"
+#include "Checkpoint.h"
 
 //-------------------------------------------------------------------------------------------------
 // Implements a number of the form 3nx^2 + 3n^2x + n^3, equivalent to (x+n)^3 - x^3
 //
-// Uses VLIntegers to avoid being confined to small numbers
+// Uses VLIntegers to avoid being confined to small numbers, Int is the VLIntN width to use,
+// SubCube is the full width version
 //
 // (c) John Whitehouse 2021-2022
 // www.eddaardvark.co.uk
 //-------------------------------------------------------------------------------------------------
 
-class SubCube
+template <class Int>
+class SubCubeT
 {
-    VLInt a;        // 3n
-    VLInt b;        // 3n^2
-    VLInt ax2;      // 2a
-    VLInt a_plus_b; // a + b
-    VLInt c;        // n^3
-    VLInt ddv;      // 2a
+    template <class> friend class SubCubeT;
+
+    Int a;        // 3n
+    Int b;        // 3n^2
+    Int ax2;      // 2a
+    Int a_plus_b; // a + b
+    Int c;        // n^3
+    Int ddv;      // 2a
 
 public:
 
-    VLInt value;    // The value (ax^2 + bx + c)
-    VLInt dv;       // 2ax + (a+b+c)
-    VLInt x;        // Current x
-    VLInt n;        // Contour
+    Int value;    // The value (ax^2 + bx + c)
+    Int dv;       // 2ax + (a+b+c)
+    Int x;        // Current x
+    Int n;        // Contour
 
     //-------------------------------------------------------------------------------------------------
-    inline SubCube()
+    inline SubCubeT()
     {
     }
 
     //-------------------------------------------------------------------------------------------------
-    inline SubCube(const SubCube& other)
+    inline SubCubeT(const SubCubeT& other)
+        : a (other.a)
+        , b (other.b)
+        , ax2 (other.ax2)
+        , a_plus_b (other.a_plus_b)
+        , c (other.c)
+        , ddv (other.ddv)
+        , value (other.value)
+        , dv (other.dv)
+        , x (other.x)
+        , n (other.n)
     {
-        a = other.a;
-        b = other.b;
-        ax2 = other.ax2;
-        a_plus_b = other.a_plus_b;
-        c = other.c;
-        x = other.x;
-        n = other.n;
-        value = other.value;
-        dv = other.dv;
-        ddv = other.ddv;
     }
 
 
     //-------------------------------------------------------------------------------------------------
-    inline SubCube (__int64 _x, __int64 contour)
+    // Convert from a different integer type
+    template <class Other>
+    inline explicit SubCubeT(const SubCubeT<Other>& other)
+        : a (other.a)
+        , b (other.b)
+        , ax2 (other.ax2)
+        , a_plus_b (other.a_plus_b)
+        , c (other.c)
+        , ddv (other.ddv)
+        , value (other.value)
+        , dv (other.dv)
+        , x (other.x)
+        , n (other.n)
+    {
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline SubCubeT (__int64 _x, __int64 contour)
     {
-        x = VLInt (_x);
-        n = VLInt (contour);
+        x = Int (_x);
+        n = Int (contour);
 
         Inflate ();
     }
     //-------------------------------------------------------------------------------------------------
-    inline SubCube (const VLInt& _x, const VLInt& contour)
+    inline SubCubeT (const Int& _x, const Int& contour)
     {
         x = _x;
         n = contour;
@@ -91,17 +112,19 @@ public:
         value = CalculateValue();
     }
     //-------------------------------------------------------------------------------------------------
-    inline VLInt CalculateValue () const
+    inline Int CalculateValue () const
     {
         return ((a * x) + b) * x + c;
     }
     //--------------------------------------------------------------------------------------------
-    inline SubCube& operator = (const SubCube& other)
+    inline SubCubeT& operator = (const SubCubeT& other)
     {
         if (this != &other)
         {
             a = other.a;
             b = other.b;
+            ax2 = other.ax2;
+            a_plus_b = other.a_plus_b;
             c = other.c;
             x = other.x;
             n = other.n;
@@ -113,30 +136,40 @@ public:
         return (*this);
     }
     //-------------------------------------------------------------------------------------------------
+    // The same as hop increments (or decrements if negative), value goes up by the sum of the
+    // next hop dv's, hop * dv + ddv * hop * (hop - 1) / 2. Only multiplies by small numbers.
     inline void Hop (__int64 hop)
     {
-        x = x + hop;
+        auto h1 = (hop % 2 == 0) ? hop / 2 : hop;
+        auto h2 = (hop % 2 == 0) ? hop - 1 : (hop - 1) / 2;
 
-        value = CalculateValue();
-        dv = a * x * 2 + (a + b);
-        ddv = a * 2;
+        value += dv * hop;
+        value += ddv * h1 * h2;
+        dv += ddv * hop;
+        x = x + hop;
+    }
+    //--------------------------------------------------------------------------------------------
+    // The dv that the last increment added, value - PreviousDV() is the value at x - 1
+    inline Int PreviousDV() const
+    {
+        return dv - ddv;
     }
     //--------------------------------------------------------------------------------------------
     // Pre increment
     //--------------------------------------------------------------------------------------------
-    inline SubCube& operator ++ ()
+    inline SubCubeT& operator ++ ()
     {
         ++ x;
-        value = value + dv;
-        dv = dv + ddv;
+        value += dv;
+        dv += ddv;
         return (*this);
     }
     //--------------------------------------------------------------------------------------------
     // Post increment
     //--------------------------------------------------------------------------------------------
-    inline SubCube operator ++ (int)
+    inline SubCubeT operator ++ (int)
     {
-        SubCube temp = *this;
+        SubCubeT temp = *this;
 
         ++(*this);
         return temp;
@@ -144,24 +177,42 @@ public:
     //--------------------------------------------------------------------------------------------
     // Pre decrement
     //--------------------------------------------------------------------------------------------
-    inline SubCube& operator -- ()
+    inline SubCubeT& operator -- ()
     {
         -- x;
-        dv = dv - ddv;
-        value = value - dv;
+        dv -= ddv;
+        value -= dv;
 
         return (*this);
     }
     //--------------------------------------------------------------------------------------------
     // Post decrement
     //--------------------------------------------------------------------------------------------
-    inline SubCube operator -- (int)
+    inline SubCubeT operator -- (int)
     {
-        SubCube temp = *this;
+        SubCubeT temp = *this;
 
         --(*this);
         return temp;
     }
+    //--------------------------------------------------------------------------------------------
+    // Checkpoints
+    //--------------------------------------------------------------------------------------------
+    inline void Save(std::ostream& os) const
+    {
+        for (auto p : { &x, &n, &value, &dv, &ddv, &a, &b, &c, &ax2, &a_plus_b })
+        {
+            Checkpoint::WriteInt(os, *p);
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    inline void Load(std::istream& is)
+    {
+        for (auto p : { &x, &n, &value, &dv, &ddv, &a, &b, &c, &ax2, &a_plus_b })
+        {
+            *p = Checkpoint::ReadInt<Int>(is);
+        }
+    }
     //=========================================================================================================
     // Monitoring and Testing
     //=========================================================================================================
@@ -174,7 +225,7 @@ public:
         return ret.str();
     }
     //------------------------------------------------------------------------------------------------------
-    inline friend std::ostream& operator << (std::ostream& os, const SubCube& vli)
+    inline friend std::ostream& operator << (std::ostream& os, const SubCubeT& vli)
     {
         return os << vli.ToString();
     }
@@ -190,126 +241,126 @@ public:
     //--------------------------------------------------------------------------------------------
     inline void Verify(const char* where) const
     {
-        SubCube good (x, n);
+        SubCubeT good (x, n);
 
         if (good.value != value)
         {
             std::stringstream sstrm;
             sstrm << where << ": SubCube: value " << value << " != " << good.value;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         if (good.dv != dv)
         {
             std::stringstream sstrm;
             sstrm << where << ": SubCube: dv " << dv << " != " << good.dv;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         if (good.ddv != ddv)
         {
             std::stringstream sstrm;
             sstrm << where << ": SubCube: ddv " << ddv << " != " << good.ddv;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         if (good.a != a)
         {
             std::stringstream sstrm;
             sstrm << where << ": SubCube: a " << a << " != " << good.a;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         if (good.b != b)
         {
             std::stringstream sstrm;
             sstrm << where << ": SubCube: b " << b << " != " << good.b;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         if (good.c != c)
         {
             std::stringstream sstrm;
             sstrm << where << ": SubCube: c " << c << " != " << good.c;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         if (good.ax2 != ax2)
         {
             std::stringstream sstrm;
             sstrm << where << ": SubCube: ax2 " << ax2 << " != " << good.ax2;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         if (good.a_plus_b != a_plus_b)
         {
             std::stringstream sstrm;
             sstrm << where << ": SubCube: a_plus_b " << a_plus_b << " != " << good.a_plus_b;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
     }
     //--------------------------------------------------------------------------------------------
     inline static void Test ()
     {
-        SubCube sc (1, 1);
+        SubCubeT sc (1, 1);
 
-        if (sc.value.ToInt () != 7) throw std::exception("SC(1,1) value");
-        if (sc.dv.ToInt() != 12) throw std::exception ("SC(1,1) dv");
-        if (sc.ddv.ToInt() != 6) throw std::exception ("SC(1,1) ddv");
+        if (sc.value.ToInt () != 7) throw std::runtime_error("SC(1,1) value");
+        if (sc.dv.ToInt() != 12) throw std::runtime_error("SC(1,1) dv");
+        if (sc.ddv.ToInt() != 6) throw std::runtime_error("SC(1,1) ddv");
 
 
         ++ sc;
-        if (sc.value.ToInt() != 19) throw std::exception("SC(1,1) inc1");
+        if (sc.value.ToInt() != 19) throw std::runtime_error("SC(1,1) inc1");
 
         ++ sc;
-        if (sc.value.ToInt() != 37) throw std::exception("SC(1,1) inc2");
+        if (sc.value.ToInt() != 37) throw std::runtime_error("SC(1,1) inc2");
 
         ++ sc;
-        if (sc.value.ToInt() != 61) throw std::exception("SC(1,1) inc3");
+        if (sc.value.ToInt() != 61) throw std::runtime_error("SC(1,1) inc3");
 
         -- sc;
-        if (sc.value.ToInt() != 37) throw std::exception("SC(1,1) dec1");
+        if (sc.value.ToInt() != 37) throw std::runtime_error("SC(1,1) dec1");
 
         -- sc;
-        if (sc.value.ToInt() != 19) throw std::exception("SC(1,1) dec2");
+        if (sc.value.ToInt() != 19) throw std::runtime_error("SC(1,1) dec2");
 
         -- sc;
-        if (sc.value.ToInt() != 7) throw std::exception("SC(1,1) dec3");
+        if (sc.value.ToInt() != 7) throw std::runtime_error("SC(1,1) dec3");
 
         -- sc;
-        if (sc.value.ToInt() != 1) throw std::exception("SC(1,1) dec4");
+        if (sc.value.ToInt() != 1) throw std::runtime_error("SC(1,1) dec4");
 
         // n = 4
 
-        sc = SubCube(1, 4);
+        sc = SubCubeT(1, 4);
 
-        if (sc.value.ToInt() != 124) throw std::exception("SC(1,4) value");
+        if (sc.value.ToInt() != 124) throw std::runtime_error("SC(1,4) value");
 
         ++ sc;
-        if (sc.value.ToInt() != 208) throw std::exception("SC(1,4) inc1");
+        if (sc.value.ToInt() != 208) throw std::runtime_error("SC(1,4) inc1");
 
         ++ sc;
-        if (sc.value.ToInt() != 316) throw std::exception("SC(1,4) inc2");
+        if (sc.value.ToInt() != 316) throw std::runtime_error("SC(1,4) inc2");
 
         ++ sc;
-        if (sc.value.ToInt() != 448) throw std::exception("SC(1,4) inc3");
+        if (sc.value.ToInt() != 448) throw std::runtime_error("SC(1,4) inc3");
 
         -- sc;
-        if (sc.value.ToInt() != 316) throw std::exception("SC(1,4) dec1");
+        if (sc.value.ToInt() != 316) throw std::runtime_error("SC(1,4) dec1");
 
         -- sc;
-        if (sc.value.ToInt() != 208) throw std::exception("SC(1,4) dec2");
+        if (sc.value.ToInt() != 208) throw std::runtime_error("SC(1,4) dec2");
 
         -- sc;
-        if (sc.value.ToInt() != 124) throw std::exception("SC(1,4) dec3");
+        if (sc.value.ToInt() != 124) throw std::runtime_error("SC(1,4) dec3");
 
         -- sc;
-        if (sc.value.ToInt() != 64) throw std::exception("SC(1,4) dec4");
+        if (sc.value.ToInt() != 64) throw std::runtime_error("SC(1,4) dec4");
 
         // Hop
 
-        SubCube sc1 (2, 11);
-        SubCube sc2 (25, 11);
+        SubCubeT sc1 (2, 11);
+        SubCubeT sc2 (25, 11);
 
         sc1.Hop(23);
         sc1.Verify("hop sc1");
@@ -319,12 +370,20 @@ public:
         {
             std::stringstream sstrm;
             sstrm << "Hop [23]: " << sc1 << " != " << sc2;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+
+        __int64 hops[4] = { -23, 1, 999999, -1000000 };
+
+        for (auto h : hops)
+        {
+            sc1.Hop(h);
+            sc1.Verify("hop sc1 (2)");
         }
 
         // Post inc
 
-        SubCube sc3 = sc2++;
+        SubCubeT sc3 = sc2++;
 
         sc2.Verify("post inc (2)");
         sc3.Verify("post inc (3)");
@@ -333,18 +392,18 @@ public:
         {
             std::stringstream sstrm;
             sstrm << "Post inc (a): " << sc2 << ", x != 26";
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
         if (sc3.x.ToInt() != 25)
         {
             std::stringstream sstrm;
             sstrm << "Post inc (b): " << sc3 << ", x != 25";
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         // Post dec
 
-        SubCube sc4 = sc3--;
+        SubCubeT sc4 = sc3--;
 
         sc3.Verify("post dec (3)");
         sc4.Verify("post dec (4)");
@@ -353,13 +412,13 @@ public:
         {
             std::stringstream sstrm;
             sstrm << "Post inc (a): " << sc3 << ", x != 24";
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
         if (sc4.x.ToInt() != 25)
         {
             std::stringstream sstrm;
             sstrm << "Post inc (b): " << sc4 << ", x != 25";
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
         // Finished
 
@@ -367,4 +426,6 @@ public:
 
     }
 
-};
\ No newline at end of file
+};
+
+typedef SubCubeT<VLInt> SubCube;
@@ -0,0 +1 @@
+#include "TieredWalker.h"
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <memory>
+
+#include "ContourWalker.h"
+#include "Int128.h"
+
+//-------------------------------------------------------------------------------------------------
+// A ContourWalker that starts on native 128 bit integers where the compiler has them, hands over
+// to Int once x gets too big for them and, if Int has a limit (Int::BITS != 0), to VLInt once x
+// gets too big for that as well. Walks a chunk at a time (Step) so that it can be shared out as
+// tasks, or all the way (Walk).
+//
+// Int is the big integer type and Point the point template (ContourPointT or DeltaPointT).
+//-------------------------------------------------------------------------------------------------
+
+template <class Int, template <class> class Point>
+class TieredWalkerT
+{
+    typedef ContourWalkerT<Int, Point<Int>> BigWalker;
+    typedef ContourWalkerT<VLInt, Point<VLInt>> HugeWalker;
+
+#ifdef __SIZEOF_INT128__
+    std::unique_ptr<ContourWalkerT<Int128, Point<Int128>>> m_fast;
+    bool m_native_to_end{ false };
+#endif
+    std::unique_ptr<BigWalker> m_big;
+    std::unique_ptr<HugeWalker> m_huge;
+    bool m_big_to_end{ false };
+    __int64 m_contour;
+    VLInt m_end_x;
+    bool m_quiet;
+
+    //--------------------------------------------------------------------------------------------
+    // Whether x is in Int's range
+    inline bool BigCanReach(const VLInt& x) const
+    {
+        if (Int::BITS == 0)
+        {
+            return true;
+        }
+
+        auto big_end_x = BigWalker::MaxEndX(m_contour, Int::BITS);
+
+        return ! big_end_x.IsZero() && x <= big_end_x;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Where the Int walker stops, the end of the walk if it can get there
+    inline VLInt BigEndX()
+    {
+        m_big_to_end = Int::BITS == 0 || (! m_end_x.IsZero() && BigCanReach(m_end_x));
+
+        return m_big_to_end ? m_end_x : BigWalker::MaxEndX(m_contour, Int::BITS);
+    }
+
+public:
+
+    // start_x = 0 for the usual start, end_x = 0 for no limit
+
+    TieredWalkerT(__int64 contour, const VLInt & start_x, __int64 steps, __int64 chunk_size, const VLInt & end_x, bool quiet = false)
+        : m_contour (contour)
+        , m_end_x (end_x)
+        , m_quiet (quiet)
+    {
+#ifdef __SIZEOF_INT128__
+        auto native_end_x = ContourWalkerT<Int128, Point<Int128>>::MaxEndX(contour, Int128::BITS);
+
+        if (! native_end_x.IsZero() && start_x <= native_end_x)
+        {
+            m_native_to_end = ! end_x.IsZero() && end_x <= native_end_x;
+            m_fast.reset(new ContourWalkerT<Int128, Point<Int128>>(contour, start_x, steps, chunk_size, m_native_to_end ? end_x : native_end_x));
+            m_fast->SetQuiet(quiet);
+            m_fast->Start();
+            return;
+        }
+#endif
+        if (BigCanReach(start_x))
+        {
+            m_big.reset(new BigWalker(contour, start_x, steps, chunk_size, BigEndX()));
+            m_big->SetQuiet(quiet);
+            m_big->Start();
+            return;
+        }
+
+        m_huge.reset(new HugeWalker(contour, start_x, steps, chunk_size, end_x));
+        m_huge->SetQuiet(quiet);
+        m_huge->Start();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Carries on from a checkpoint, on the narrowest integers that the saved x is in range of
+
+    TieredWalkerT(std::istream& is, __int64 contour, __int64 steps, __int64 chunk_size, const VLInt & end_x, bool quiet = false)
+        : m_contour (contour)
+        , m_end_x (end_x)
+        , m_quiet (quiet)
+    {
+        m_huge.reset(new HugeWalker(contour, steps, chunk_size, end_x));
+        m_huge->SetQuiet(quiet);
+        m_huge->Load(is);
+
+        if (! BigCanReach(VLInt(m_huge->X())))
+        {
+            return;
+        }
+
+        m_big.reset(new BigWalker(*m_huge, BigEndX()));
+        m_huge.reset();
+
+#ifdef __SIZEOF_INT128__
+        auto native_end_x = ContourWalkerT<Int128, Point<Int128>>::MaxEndX(contour, Int128::BITS);
+
+        if (! native_end_x.IsZero() && VLInt(m_big->X()) <= native_end_x)
+        {
+            m_native_to_end = ! end_x.IsZero() && end_x <= native_end_x;
+            m_fast.reset(new ContourWalkerT<Int128, Point<Int128>>(*m_big, m_native_to_end ? end_x : native_end_x));
+            m_big.reset();
+        }
+#endif
+    }
+    //--------------------------------------------------------------------------------------------
+    void Save(std::ostream& os) const
+    {
+#ifdef __SIZEOF_INT128__
+        if (m_fast)
+        {
+            m_fast->Save(os);
+            return;
+        }
+#endif
+        if (m_big)
+        {
+            m_big->Save(os);
+            return;
+        }
+        m_huge->Save(os);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Carried over when the walk moves up a tier
+    void SetPredict(__int64 rows)
+    {
+#ifdef __SIZEOF_INT128__
+        if (m_fast)
+        {
+            m_fast->SetPredict(rows);
+            return;
+        }
+#endif
+        if (m_big)
+        {
+            m_big->SetPredict(rows);
+            return;
+        }
+        m_huge->SetPredict(rows);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Waits until the results found so far are recorded and queued for the results file
+    void Drain() const
+    {
+#ifdef __SIZEOF_INT128__
+        if (m_fast)
+        {
+            m_fast->Drain();
+            return;
+        }
+#endif
+        if (m_big)
+        {
+            m_big->Drain();
+            return;
+        }
+        m_huge->Drain();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Walks one chunk, returns false once there is nothing left to walk
+    bool Step()
+    {
+#ifdef __SIZEOF_INT128__
+        if (m_fast)
+        {
+            if (m_fast->Step())
+            {
+                return true;
+            }
+
+            if (m_native_to_end || ! m_fast->ChunksLeft() || ResultWriter::Interrupted())
+            {
+                return false;
+            }
+
+            if (! m_quiet)
+            {
+                std::stringstream sstrm;
+
+                sstrm << "Switching to big integers at x = " << m_fast->X() << "\n";
+                std::cout << sstrm.str() << std::flush;
+            }
+
+            m_big.reset(new BigWalker(*m_fast, BigEndX()));
+            m_fast.reset();
+            return true;
+        }
+#endif
+        if (m_big)
+        {
+            return BigStepped(m_big->Step());
+        }
+        return m_huge->Step();
+    }
+    //--------------------------------------------------------------------------------------------
+    // The Int walker, if that's the one walking, for LaneWalkerT to step
+    inline BigWalker * Big() const
+    {
+        return m_big.get();
+    }
+    //--------------------------------------------------------------------------------------------
+    // The rest of Step after the Int walker has stepped, returning more as it did. Hands over to
+    // VLInt if it stopped at the end of its range.
+    bool BigStepped(bool more)
+    {
+        if (more)
+        {
+            return true;
+        }
+
+        if (m_big_to_end || ! m_big->ChunksLeft() || ResultWriter::Interrupted())
+        {
+            return false;
+        }
+
+        if (! m_quiet)
+        {
+            std::stringstream sstrm;
+
+            sstrm << "Switching to unlimited integers at x = " << m_big->X() << "\n";
+            std::cout << sstrm.str() << std::flush;
+        }
+
+        m_huge.reset(new HugeWalker(*m_big, m_end_x));
+        m_big.reset();
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    void Walk()
+    {
+        while (Step())
+        {
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    inline __int64 Contour() const
+    {
+        return m_contour;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline VLInt X() const
+    {
+#ifdef __SIZEOF_INT128__
+        if (m_fast)
+        {
+            return VLInt(m_fast->X());
+        }
+#endif
+        return m_big ? VLInt(m_big->X()) : m_huge->X();
+    }
+    //--------------------------------------------------------------------------------------------
+    inline const WalkingResults& Results() const
+    {
+#ifdef __SIZEOF_INT128__
+        if (m_fast)
+        {
+            return m_fast->Results();
+        }
+#endif
+        return m_big ? m_big->Results() : m_huge->Results();
+    }
+    //--------------------------------------------------------------------------------------------
+    inline std::vector<Result> TakeResults()
+    {
+#ifdef __SIZEOF_INT128__
+        if (m_fast)
+        {
+            return m_fast->TakeResults();
+        }
+#endif
+        return m_big ? m_big->TakeResults() : m_huge->TakeResults();
+    }
+    //--------------------------------------------------------------------------------------------
+    inline const SpotterStats& Families() const
+    {
+#ifdef __SIZEOF_INT128__
+        if (m_fast)
+        {
+            return m_fast->Families();
+        }
+#endif
+        return m_big ? m_big->Families() : m_huge->Families();
+    }
+    //--------------------------------------------------------------------------------------------
+    inline __int64 Rows() const
+    {
+#ifdef __SIZEOF_INT128__
+        if (m_fast)
+        {
+            return m_fast->Rows();
+        }
+#endif
+        return m_big ? m_big->Rows() : m_huge->Rows();
+    }
+};
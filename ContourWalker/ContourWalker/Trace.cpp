@@ -0,0 +1 @@
+#include "Trace.h"
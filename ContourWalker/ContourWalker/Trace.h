@@ -0,0 +1,274 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Platform.h"
+
+//-------------------------------------------------------------------------------------------------
+// Optional tracing of where a walk's time goes, written as a Chrome trace (chrome://tracing or
+// ui.perfetto.dev) so that slow phases, and stalls between threads, can be looked at.
+//
+// A Span times the scope it is declared in and, while tracing is on, records it as an event with
+// nanosecond timestamps. Each thread records into its own buffer, blocks of events that only it
+// writes, publishing the count with a release store, so recording takes no locks. A thread takes
+// the lock once, to register its buffer. When tracing is off a Span is an atomic load.
+//
+// Start turns tracing on, Stop turns it off and writes everything recorded. Threads that have
+// finished keep their events until then.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+class Trace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    struct Event
+    {
+        const char * name;          // Spans are named with string literals
+        __int64 start;              // ns since Start
+        __int64 duration;
+    };
+
+    static const int BLOCK_EVENTS = 4096;
+    static const int MAX_BLOCKS = 256;      // Past a million events a thread drops the rest
+
+    // One thread's events, only that thread adds to them
+
+    class Buffer
+    {
+        std::unique_ptr<Event[]> m_blocks[MAX_BLOCKS];
+        std::atomic<__int64> m_count{ 0 };
+        __int64 m_dropped{ 0 };
+        int m_thread;
+
+        friend class Trace;
+
+    public:
+
+        explicit Buffer(int thread)
+            : m_thread (thread)
+        {
+        }
+        //--------------------------------------------------------------------------------------------
+        inline void Add(const char * name, __int64 start, __int64 end)
+        {
+            auto count = m_count.load(std::memory_order_relaxed);
+            auto block = count / BLOCK_EVENTS;
+
+            if (block == MAX_BLOCKS)
+            {
+                ++m_dropped;
+                return;
+            }
+
+            if (! m_blocks[block])
+            {
+                m_blocks[block].reset(new Event[BLOCK_EVENTS]);
+            }
+
+            m_blocks[block][count % BLOCK_EVENTS] = { name, start, end - start };
+            m_count.store(count + 1, std::memory_order_release);
+        }
+    };
+
+    std::mutex m_lock;                              // For m_buffers
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+    std::atomic<bool> m_enabled{ false };
+    Clock::time_point m_origin{ Clock::now() };
+
+public:
+
+    // Times its scope
+
+    class Span
+    {
+        const char * m_name;
+        __int64 m_start;            // -1 when tracing is off
+
+    public:
+
+        inline explicit Span(const char * name)
+            : m_name (name)
+            , m_start (Enabled() ? Now() : -1)
+        {
+        }
+        //--------------------------------------------------------------------------------------------
+        inline ~Span()
+        {
+            if (m_start >= 0)
+            {
+                ThisThread().Add(m_name, m_start, Now());
+            }
+        }
+    };
+
+    //--------------------------------------------------------------------------------------------
+    static void Start()
+    {
+        auto& trace = Instance();
+
+        trace.m_origin = Clock::now();
+        trace.m_enabled.store(true, std::memory_order_release);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Writes what has been recorded to file_name and starts again, called once the threads have
+    // finished with their spans
+    static void Stop(const std::string& file_name)
+    {
+        auto& trace = Instance();
+
+        trace.m_enabled.store(false, std::memory_order_release);
+        trace.Write(file_name);
+    }
+    //--------------------------------------------------------------------------------------------
+    static inline bool Enabled()
+    {
+        return Instance().m_enabled.load(std::memory_order_acquire);
+    }
+
+    //=========================================================================================================
+    // Testing
+    //=========================================================================================================
+    // Spans on two threads, nested ones inside their parents
+    inline static void Test()
+    {
+        std::string file_name = "trace_test.json";
+
+        Start();
+
+        auto spans = []()
+        {
+            for (int i = 0; i < 10; ++i)
+            {
+                Span outer("outer");
+                Span inner("inner");
+            }
+        };
+
+        std::thread other(spans);
+
+        spans();
+        other.join();
+        Stop(file_name);
+
+        std::ifstream file(file_name);
+        std::stringstream text;
+        text << file.rdbuf();
+        file.close();
+        std::remove(file_name.c_str());
+
+        auto json = text.str();
+        int outer = 0;
+        int inner = 0;
+
+        for (auto at = json.find("\"name\": \""); at != std::string::npos; at = json.find("\"name\": \"", at + 1))
+        {
+            outer += json.compare(at + 9, 6, "outer\"") == 0;
+            inner += json.compare(at + 9, 6, "inner\"") == 0;
+        }
+
+        if (outer != 20 || inner != 20 || json.find("\"traceEvents\": [") == std::string::npos || Enabled())
+        {
+            std::stringstream sstrm;
+            sstrm << "Trace test: " << outer << " outer and " << inner << " inner spans, expected 20 of each";
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+
+        // Finished
+
+        std::cout << "Trace: All tests passed." << std::endl;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    static inline __int64 Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - Instance().m_origin).count();
+    }
+    //--------------------------------------------------------------------------------------------
+    // This thread's buffer, registered on its first span
+    static Buffer& ThisThread()
+    {
+        thread_local Buffer * buffer = nullptr;
+
+        if (buffer == nullptr)
+        {
+            auto& trace = Instance();
+            std::lock_guard<std::mutex> guard(trace.m_lock);
+
+            trace.m_buffers.emplace_back(new Buffer((int)trace.m_buffers.size() + 1));
+            buffer = trace.m_buffers.back().get();
+        }
+        return *buffer;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Complete ("X") events, timestamps in microseconds, then empties the buffers
+    void Write(const std::string& file_name)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        std::ofstream file(file_name);
+        __int64 dropped = 0;
+        bool first = true;
+
+        if (! file)
+        {
+            throw std::runtime_error("Can't write the trace " + file_name);
+        }
+
+        file << "{\"traceEvents\": [" << std::endl;
+
+        for (auto& buffer : m_buffers)
+        {
+            auto count = buffer->m_count.load(std::memory_order_acquire);
+
+            file << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->m_thread
+                 << ", \"args\": {\"name\": \"thread " << buffer->m_thread << "\"}}";
+            first = false;
+
+            for (__int64 i = 0; i < count; ++i)
+            {
+                auto& event = buffer->m_blocks[i / BLOCK_EVENTS][i % BLOCK_EVENTS];
+
+                file << ",\n{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->m_thread
+                     << ", \"ts\": " << event.start / 1000 << "." << Decimals(event.start % 1000)
+                     << ", \"dur\": " << event.duration / 1000 << "." << Decimals(event.duration % 1000) << "}";
+            }
+
+            dropped += buffer->m_dropped;
+            buffer->m_count.store(0, std::memory_order_release);
+            buffer->m_dropped = 0;
+        }
+
+        file << std::endl << "], \"displayTimeUnit\": \"ns\", \"otherData\": {\"dropped\": " << dropped << "}}" << std::endl;
+    }
+    //--------------------------------------------------------------------------------------------
+    // The ns part of a time in microseconds
+    static std::string Decimals(__int64 ns)
+    {
+        std::stringstream sstrm;
+
+        sstrm << std::setw(3) << std::setfill('0') << ns;
+        return sstrm.str();
+    }
+    //--------------------------------------------------------------------------------------------
+    static Trace& Instance()
+    {
+        static Trace trace;
+        return trace;
+    }
+};
@@ -1,7 +1,8 @@
 #pragma once
 
 //-------------------------------------------------------------------------------------------------
-// Stores very large integers as a set of smaller ones (base 10^N)
+// Stores very large integers as a set of smaller ones (base 2^32), N is the number of limbs,
+// VLInt is VLIntN<0>, which has no limit
 // 
 // (c) John Whitehouse 2019-2022
 // www.eddaardvark.co.uk
@@ -13,47 +14,66 @@
 #include <stdexcept>
 #include <iomanip>
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 
 #include "VLUInt.h"
 
-class VLInt
+template <int N>
+class VLIntN
 {
 public:
 
+    static const int BITS = 32 * N;     // Not counting the sign, 0 for no limit
+
     bool positive{ true };      // Sign
-    VLUInt value;               // Unsigned value
+    VLUIntN<N> value;               // Unsigned value
 
     int length{ 0 };
     
 
-    inline VLInt() : value(0), positive(true) {}
+    inline VLIntN() : value(0), positive(true) {}
 
     //----------------------------------------------------------------------------------------------------------------
-    inline VLInt (__int64 n)
+    inline VLIntN (__int64 n)
         : positive (n >= 0)
-        , value (abs(n))
+        , value (std::llabs(n))
     {
     }
     //--------------------------------------------------------------------------------------------
-    inline VLInt (const VLInt & other)
+    inline VLIntN (const VLIntN & other)
         : positive (other.positive)
         , value (other.value)
     {
     }
     //--------------------------------------------------------------------------------------------
-    inline VLInt(const VLUInt& val, bool pstve)
+    inline VLIntN (VLIntN && other)
+        : positive (other.positive)
+        , value (std::move(other.value))
+    {
+    }
+    //--------------------------------------------------------------------------------------------
+    inline VLIntN(const VLUIntN<N>& val, bool pstve)
         : positive(pstve)
         , value (val)
     {
     }
     //--------------------------------------------------------------------------------------------
+    // Convert from a different width
+    //--------------------------------------------------------------------------------------------
+    template <int M>
+    inline explicit VLIntN (const VLIntN<M>& other)
+        : positive (other.positive)
+        , value (other.value)
+    {
+    }
+    //--------------------------------------------------------------------------------------------
     inline bool TestSmall(int target) const
     {
         return value.TestSmall(target);
     }
     //--------------------------------------------------------------------------------------------
-    inline VLInt & operator = (const VLInt& other)
+    inline VLIntN & operator = (const VLIntN& other)
     {
         if (this != &other)
         {
@@ -64,40 +84,51 @@ public:
         return (* this);
     }
     //--------------------------------------------------------------------------------------------
-    inline VLInt& operator = (__int64 other)
+    inline VLIntN & operator = (VLIntN&& other)
+    {
+        if (this != &other)
+        {
+            positive = other.positive;
+            value = std::move(other.value);
+        }
+
+        return (* this);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline VLIntN& operator = (__int64 other)
     {
         positive = other >= 0;
-        value = abs(other);
+        value = std::llabs(other);
 
         return (*this);
     }
     //--------------------------------------------------------------------------------------------
     // Multiply by a simple integer
     //--------------------------------------------------------------------------------------------
-    inline VLInt operator * (__int64 num) const
+    inline VLIntN operator * (__int64 num) const
     {
-        VLUInt val = value * num;
-        bool pstve = positive == (num >= 0);
+        VLUIntN<N> val = value * (num < 0 ? -num : num);
+        bool pstve = val.IsZero() || positive == (num >= 0);
 
-        return VLInt (val, pstve);
+        return VLIntN (val, pstve);
     }
     //--------------------------------------------------------------------------------------------
     // Multiply by a another big integer
     //--------------------------------------------------------------------------------------------
-    inline VLInt operator * (const VLInt & other) const
+    inline VLIntN operator * (const VLIntN & other) const
     {
-        VLUInt val = value * other.value;
+        VLUIntN<N> val = value * other.value;
         bool pstve = positive == other.positive;
 
-        return VLInt(val, pstve);
+        return VLIntN(val, pstve);
     }
     //--------------------------------------------------------------------------------------------
     // Add a simple number (this number is truncated to an integer)
     // TODO: Optimise using values directly
     //--------------------------------------------------------------------------------------------
-    inline VLInt operator + (__int64 num) const
+    inline VLIntN operator + (__int64 num) const
     {
-        auto n = VLInt(num);
+        auto n = VLIntN(num);
 
         return (*this) + n;
     }
@@ -105,16 +136,16 @@ public:
     // Subtract a simple number
     // TODO: Optimise using values directly
     //--------------------------------------------------------------------------------------------
-    inline VLInt operator - (__int64 num) const
+    inline VLIntN operator - (__int64 num) const
     {
-        auto n = VLInt(num);
+        auto n = VLIntN(num);
 
         return (*this) - n;
     }
     //--------------------------------------------------------------------------------------------
     // Pre increment
     //--------------------------------------------------------------------------------------------
-    inline VLInt & operator ++ ()
+    inline VLIntN & operator ++ ()
     {
         if (IsZero())
         {
@@ -135,9 +166,9 @@ public:
     //--------------------------------------------------------------------------------------------
     // Post increment
     //--------------------------------------------------------------------------------------------
-    inline VLInt operator ++ (int)
+    inline VLIntN operator ++ (int)
     {
-        VLInt temp = *this;
+        VLIntN temp = *this;
         
         ++ (*this);
         return temp;
@@ -145,7 +176,7 @@ public:
     //--------------------------------------------------------------------------------------------
     // Pre decrement
     //--------------------------------------------------------------------------------------------
-    inline VLInt& operator -- ()
+    inline VLIntN& operator -- ()
     {
         if (IsZero())
         {
@@ -166,9 +197,9 @@ public:
     //--------------------------------------------------------------------------------------------
     // Post decrement
     //--------------------------------------------------------------------------------------------
-    inline VLInt operator -- (int)
+    inline VLIntN operator -- (int)
     {
-        VLInt temp = *this;
+        VLIntN temp = *this;
 
         --(*this);
         return temp;
@@ -176,125 +207,183 @@ public:
     //--------------------------------------------------------------------------------------------
     // Add
     //--------------------------------------------------------------------------------------------
-    inline VLInt operator + (const VLInt & other) const
+    inline VLIntN operator + (const VLIntN & other) const
     {
         if (other.positive == positive)
         {
-            VLUInt val = value + other.value;
-            return VLInt (val, positive);
+            VLUIntN<N> val = value + other.value;
+            return VLIntN (val, positive);
         }
 
-        auto comp = VLUInt::Compare (value, other.value);
+        auto comp = VLUIntN<N>::Compare (value, other.value);
 
         if (comp == 0) // A + (-A) = 0
         {
-            return VLInt(0);
+            return VLIntN(0);
         }
 
         if (comp > 0)
         {
-            VLUInt val = value - other.value;
-            return VLInt(val, positive);
+            VLUIntN<N> val = value - other.value;
+            return VLIntN(val, positive);
         }
 
-        VLUInt val = other.value - value;
-        return VLInt(val, other.positive);
+        VLUIntN<N> val = other.value - value;
+        return VLIntN(val, other.positive);
     }
     //--------------------------------------------------------------------------------------------
     // Subtract
     //--------------------------------------------------------------------------------------------
-    inline VLInt operator - (const VLInt& other) const
+    inline VLIntN operator - (const VLIntN& other) const
     {
         if (other.positive != positive)
         {
-            VLUInt val = value + other.value;
-            return VLInt(val, positive);
+            VLUIntN<N> val = value + other.value;
+            return VLIntN(val, positive);
         }
 
-        auto comp = VLUInt::Compare(value, other.value);
+        auto comp = VLUIntN<N>::Compare(value, other.value);
 
         if (comp == 0) // A - A = 0
         {
-            return VLInt(0);
+            return VLIntN(0);
         }
 
         if (comp > 0)
         {
-            VLUInt val = value - other.value;
-            return VLInt(val, positive);
+            VLUIntN<N> val = value - other.value;
+            return VLIntN(val, positive);
         }
 
 
-        VLUInt val = other.value - value;
-        return VLInt(val, ! other.positive);
+        VLUIntN<N> val = other.value - value;
+        return VLIntN(val, ! other.positive);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Add in place, same results as + without the temporary
+    //--------------------------------------------------------------------------------------------
+    inline VLIntN& operator += (const VLIntN& other)
+    {
+        if (other.positive == positive)
+        {
+            value += other.value;
+            return (*this);
+        }
+
+        auto comp = VLUIntN<N>::Compare(value, other.value);
+
+        if (comp == 0) // A + (-A) = 0
+        {
+            value = 0;
+            positive = true;
+        }
+        else if (comp > 0)
+        {
+            value -= other.value;
+        }
+        else
+        {
+            value.SubtractFrom(other.value);
+            positive = other.positive;
+        }
+        return (*this);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Subtract in place
+    //--------------------------------------------------------------------------------------------
+    inline VLIntN& operator -= (const VLIntN& other)
+    {
+        if (other.positive != positive)
+        {
+            value += other.value;
+            return (*this);
+        }
+
+        auto comp = VLUIntN<N>::Compare(value, other.value);
+
+        if (comp == 0) // A - A = 0
+        {
+            value = 0;
+            positive = true;
+        }
+        else if (comp > 0)
+        {
+            value -= other.value;
+        }
+        else
+        {
+            value.SubtractFrom(other.value);
+            positive = ! other.positive;
+        }
+        return (*this);
     }
     //--------------------------------------------------------------------------------------------
     // Compare, returns -1, 0 or 1 for (first < second), (first == second) and (first > second)
     //--------------------------------------------------------------------------------------------
-    inline static int Compare (const VLInt & first, const VLInt& second)
+    inline static int Compare (const VLIntN & first, const VLIntN& second)
     {
         if (first.positive != second.positive)
         {
             return first.positive ? 1 : -1;
         }
 
-        auto c = VLUInt::Compare(first.value, second.value);
+        auto c = VLUIntN<N>::Compare(first.value, second.value);
 
         return first.positive ? c : -c;
     }
     //--------------------------------------------------------------------------------------------
     // returns the minimum (by reference)
     //--------------------------------------------------------------------------------------------
-    inline static const VLInt & Min (const VLInt& first, const VLInt& second)
+    inline static const VLIntN & Min (const VLIntN& first, const VLIntN& second)
     {
         return (Compare(first, second) > 0) ? second : first;
     }
     //--------------------------------------------------------------------------------------------
     // returns the maximum (by reference)
     //--------------------------------------------------------------------------------------------
-    inline static const VLInt & Max(const VLInt& first, const VLInt& second)
+    inline static const VLIntN & Max(const VLIntN& first, const VLIntN& second)
     {
         return (Compare(first, second) > 0) ? first : second;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator > (const VLInt& other) const
+    inline bool operator > (const VLIntN& other) const
     {
         return Compare((*this), other) > 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator >= (const VLInt& other) const
+    inline bool operator >= (const VLIntN& other) const
     {
         return Compare((*this), other) >= 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator < (const VLInt& other) const
+    inline bool operator < (const VLIntN& other) const
     {
         return Compare((*this), other) < 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator <= (const VLInt& other) const
+    inline bool operator <= (const VLIntN& other) const
     {
         return Compare((*this), other) <= 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator == (const VLInt& other) const
+    inline bool operator == (const VLIntN& other) const
     {
         return Compare((*this), other) == 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator != (const VLInt& other) const
+    inline bool operator != (const VLIntN& other) const
     {
         return Compare((*this), other) != 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline VLInt Abs () const
+    inline VLIntN Abs () const
     {
-        return VLInt(value, true);
+        return VLIntN(value, true);
     }
     //--------------------------------------------------------------------------------------------
-    inline VLInt operator - () const
+    inline VLIntN operator - () const
     {
-        return VLInt(value, !positive);
+        return VLIntN(value, !positive);
     }
     //--------------------------------------------------------------------------------------------
     inline bool IsZero () const
@@ -302,6 +391,11 @@ public:
         return value.IsZero();
     }
     //--------------------------------------------------------------------------------------------
+    inline bool IsPositive () const
+    {
+        return positive;
+    }
+    //--------------------------------------------------------------------------------------------
     inline int Mod2 () const { return value.Mod2(); }
     inline int Mod3() const { return value.Mod3(); }
     inline int Mod4() const { return value.Mod4(); }
@@ -312,44 +406,47 @@ public:
     inline int Mod16() const { return value.Mod16(); }
     
     //--------------------------------------------------------------------------------------------
-    // Divide by an integer (< BASE)
-    inline VLInt operator / (__int64 number)
+    // Divide by an integer
+    inline VLIntN operator / (__int64 number) const
     {
-        VLUInt val = value / abs(number);
-        bool pstve = positive == (number >= 0);
-
-        return VLInt(val, pstve);
+        return (*this) / VLIntN(number);
     }
     //--------------------------------------------------------------------------------------------
-    inline __int64 Remainder (__int64 number)
+    inline __int64 Remainder (__int64 number) const
     {
         return value.DivMod(number).second;
     }
-
-    // Divide, this/other, returns a VLInt
-
-    inline VLInt operator / (const VLInt& other)
+    //--------------------------------------------------------------------------------------------
+    // Divide, this/other, returns the quotient and the remainder. Rounds towards zero, like the
+    // built in types, so the remainder has the sign of this.
+    inline std::pair<VLIntN, VLIntN> DivMod(const VLIntN& other) const
     {
-        if (other.IsZero())
-        {
-            throw std::invalid_argument("Divide by zero");
-        }
+        auto dm = value.DivMod(other.value);
 
-        VLUInt val = value / other.value;
-        bool pstve = positive == other.positive;
-        return VLInt(val, pstve);
+        return std::make_pair(VLIntN(dm.first, positive == other.positive || dm.first.IsZero()),
+                              VLIntN(dm.second, positive || dm.second.IsZero()));
+    }
+    //--------------------------------------------------------------------------------------------
+    inline VLIntN operator / (const VLIntN& other) const
+    {
+        return DivMod(other).first;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline VLIntN operator % (const VLIntN& other) const
+    {
+        return DivMod(other).second;
     }
 
     //------------------------------------------------------------------------------------------------------
     // Calculates this^n (n is a positive integer, doesn't do fractional or negative powers)
-    inline VLInt Pow(int n)
+    inline VLIntN Pow(int n)
     {
-        if (n < 1) return VLInt(1);
+        if (n < 1) return VLIntN(1);
 
-        VLUInt val = value.Pow(n);
+        VLUIntN<N> val = value.Pow(n);
         bool pstve = positive || (n % 2) == 0;
 
-        return VLInt(val, pstve);
+        return VLIntN(val, pstve);
     }
     //------------------------------------------------------------------------------------------------------
     // Convert to f * 10^n (ignores the sign)
@@ -358,7 +455,7 @@ public:
     {
         if (IsZero())
         {
-            throw std::exception("zero not supported");
+            throw std::runtime_error("zero not supported");
         }
 
         auto ret = value.MantissaExponent();
@@ -382,7 +479,7 @@ public:
         return value.Log10();
     }
     //------------------------------------------------------------------------------------------------------
-    inline static double Ratio (const VLInt & b1, const VLInt& b2)
+    inline static double Ratio (const VLIntN & b1, const VLIntN& b2)
     {
         auto m1 = b1.MantissaExponent();
         auto m2 = b2.MantissaExponent();
@@ -390,14 +487,14 @@ public:
         return (m1.first / m2.first) * pow(10, (m1.second - m2.second));
     }
     //------------------------------------------------------------------------------------------------------
-    inline VLInt Square () const
+    inline VLIntN Square () const
     {
-        return (*this) * (*this);
+        return VLIntN(value.Square(), true);
     }
     //------------------------------------------------------------------------------------------------------
-    inline VLInt Cube () const
+    inline VLIntN Cube () const
     {
-        return (*this) * (*this) * (*this);
+        return VLIntN(value.Cube(), positive || value.IsZero());
     }
     //------------------------------------------------------------------------------------------------------
     inline double CubeRoot () const
@@ -413,6 +510,37 @@ public:
         return pow(me.first, 1.0 / 3.0) * pow(10, me.second / 3);
     }
     //------------------------------------------------------------------------------------------------------
+    // Exact nth root, rounded towards zero, and what's left over, this = root^n + remainder with
+    // the remainder taking the sign of this. Even roots of negative numbers throw.
+    inline std::pair<VLIntN, VLIntN> IRootRem (int n) const
+    {
+        if (!positive && n % 2 == 0 && !value.IsZero())
+        {
+            throw std::invalid_argument("IRoot: even root of a negative number");
+        }
+
+        auto rr = value.IRootRem(n);
+
+        return std::make_pair(VLIntN(rr.first, positive || rr.first.IsZero()),
+                              VLIntN(rr.second, positive || rr.second.IsZero()));
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline VLIntN IRoot (int n) const
+    {
+        return IRootRem(n).first;
+    }
+    //------------------------------------------------------------------------------------------------------
+    // Exact cube root, rounded towards zero
+    inline VLIntN ICbrt () const
+    {
+        return IRootRem(3).first;
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline std::pair<VLIntN, VLIntN> ICbrtRem () const
+    {
+        return IRootRem(3);
+    }
+    //------------------------------------------------------------------------------------------------------
     // Don't define operator so that we don't call this by mistake
     inline __int64 ToInt () const
     {
@@ -442,7 +570,37 @@ public:
         return ret.str();
     }
     //------------------------------------------------------------------------------------------------------
-    inline friend std::ostream& operator << (std::ostream & os, const VLInt & vli)
+    // Parse a string of decimal digits with an optional leading '-'
+    inline static VLIntN FromString(const std::string& text)
+    {
+        if (!text.empty() && text[0] == '-')
+        {
+            return VLIntN(VLUIntN<N>::FromString(text.substr(1)), false);
+        }
+        return VLIntN(VLUIntN<N>::FromString(text), true);
+    }
+    //------------------------------------------------------------------------------------------------------
+    // Binary form for checkpoints, the sign then the value
+    inline void Save(std::ostream& os) const
+    {
+        char sign = positive ? 1 : 0;
+
+        os.write(&sign, 1);
+        value.Save(os);
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline static VLIntN Load(std::istream& is)
+    {
+        char sign = 1;
+
+        is.read(&sign, 1);
+
+        auto val = VLUIntN<N>::Load(is);
+
+        return VLIntN(val, sign != 0 || val.IsZero());
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline friend std::ostream& operator << (std::ostream & os, const VLIntN & vli)
     {
         return os << vli.ToString();
     }
@@ -459,7 +617,7 @@ public:
         for (auto i = 0; i < 3; ++i)
         {
             __int64 x = start[i];
-            VLInt vlx (start[i]);
+            VLIntN vlx (start[i]);
 
             if (vlx.ToInt() != x)
             {
@@ -467,7 +625,7 @@ public:
                 
                 sstrm << "Initialise vlx " << start[i] << " returned " << vlx;
                 
-                throw std::exception(sstrm.str().c_str());
+                throw std::runtime_error(sstrm.str().c_str());
             }
 
             for (auto j = 0; j < 11; ++j)
@@ -482,7 +640,7 @@ public:
 
                     sstrm << "Add: " << was << " + " << to_add[j] << ", got " << vlx << ", expected " << x;
 
-                    throw std::exception(sstrm.str().c_str());
+                    throw std::runtime_error(sstrm.str().c_str());
                 }
             }
         }
@@ -492,7 +650,7 @@ public:
         for (auto i = 0; i < 3; ++i)
         {
             __int64 x = start[i];
-            VLInt vlx (start[i]);
+            VLIntN vlx (start[i]);
 
             for (auto j = 0; j < 11; ++j)
             {
@@ -506,7 +664,7 @@ public:
 
                     sstrm << "Add: " << was << " - " << to_add[j] << ", got " << vlx << ", expected " << x;
 
-                    throw std::exception(sstrm.str().c_str());
+                    throw std::runtime_error(sstrm.str().c_str());
                 }
             }
         }
@@ -515,9 +673,9 @@ public:
 
         std::string f40 = "815915283247897734345611269596115894272000000000";
 
-        static VLInt fn[41];
+        static VLIntN fn[41];
         
-        fn[0] = VLInt(1);
+        fn[0] = VLIntN(1);
 
         for (int i = 1; i <= 40; ++i)
         {
@@ -526,23 +684,23 @@ public:
 
         if (fn[40].ToString() != f40)
         {
-            throw std::exception("Factorial 40");
+            throw std::runtime_error("Factorial 40");
         }
 
         // Factorials (multiply by VLInt)
 
-        VLInt fact (1);
+        VLIntN fact (1);
 
         for (int i = 1; i <= 40; ++i)
         {
-            VLInt vli (i);
+            VLIntN vli (i);
             fact = fact * vli;
 
             if (fact != fn[i])
             {
                 std::stringstream sstrm;
                 sstrm << "Factorial [" << i << "] " << fact << " != " << fn[i];
-                throw std::exception(sstrm.str().c_str());
+                throw std::runtime_error(sstrm.str().c_str());
             }
         }
 
@@ -551,7 +709,7 @@ public:
         for (int i = 0; i < 40; ++i)
         {
             int n = 40 - i;
-            VLInt vli (n);
+            VLIntN vli (n);
 
             fact = fact / vli;
 
@@ -559,13 +717,41 @@ public:
             {
                 std::stringstream sstrm;
                 sstrm << "Factorial Division [" << i << "] " << fact << " != " << fn[n-1];
-                throw std::exception(sstrm.str().c_str());
+                throw std::runtime_error(sstrm.str().c_str());
             }
         }
 
+        // Signs, rounding towards zero like the built in types
+
+        for (int i = 0; i < 4; ++i)
+        {
+            __int64 n = (i % 2 == 0) ? 1000000007 : -1000000007;
+            __int64 d = (i < 2) ? 1000 : -1000;
+            auto dm = VLIntN(n).DivMod(VLIntN(d));
+
+            if (dm.first != n / d || dm.second != n % d || VLIntN(n) / d != n / d)
+            {
+                std::stringstream sstrm;
+                sstrm << "Signed division: " << n << " / " << d << " = " << dm.first << " remainder " << dm.second;
+                throw std::runtime_error(sstrm.str().c_str());
+            }
+        }
+
+        // Roots of negative numbers
+
+        auto m1000 = VLIntN(-1000000007);
+        auto cr = m1000.ICbrtRem();
+
+        if (cr.first != -1000 || cr.second != -7 || m1000.IRoot(5) != -63)
+        {
+            std::stringstream sstrm;
+            sstrm << "Signed root: cbrt(" << m1000 << ") = " << cr.first << " remainder " << cr.second << ", 5th root = " << m1000.IRoot(5);
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+
         // Cubes, Mod 9, Mod 3 + increment
 
-        VLInt vli (1000000);
+        VLIntN vli (1000000);
         static int mod9[3] = { 0, 1, 8 };
 
         for (int i = 0; i < 40; ++i)
@@ -578,7 +764,7 @@ public:
             {
                 std::stringstream sstrm;
                 sstrm << "Modulo test: " << vli << " cubed = " << c << ", mod 9 = " << m9 << ", mod 3 = " << m3 << std::endl;
-                throw std::exception(sstrm.str().c_str());
+                throw std::runtime_error(sstrm.str().c_str());
             }
 
             ++vli;
@@ -595,12 +781,12 @@ public:
         {
             std::stringstream sstrm;
             sstrm << "Decrement test: " << vli << " !- " << 1000000 << std::endl;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         // Log 10
 
-        vli = VLInt(2);
+        vli = VLIntN(2);
         auto log2 = log10(2.0);
         auto check = (int)((log2 - (int)round(log2)) * 100000000);
 
@@ -615,15 +801,15 @@ public:
             {
                 std::stringstream sstrm;
                 sstrm << "Power test: " << "Log (" << vli << ") = " << l2 << ": expected " << ipart << " == " << i << " and " << ifpart << " == " << check << std::endl;
-                throw std::exception(sstrm.str().c_str());
+                throw std::runtime_error(sstrm.str().c_str());
             }
             vli = vli * 10;
         }
 
         // Ratio & Pow, should give 1.099511627776
 
-        VLInt two (2);
-        VLInt ten (10);
+        VLIntN two (2);
+        VLIntN ten (10);
         auto rcheck = 99511627776L;
 
         ten = ten.Pow(12);
@@ -636,7 +822,7 @@ public:
         {
             std::stringstream sstrm;
             sstrm << "Ratio test: " << two << " / " << ten << " = " << rat << " (" << rcheck << " != " << rchk2 << ") " << std::endl;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         // Finished
@@ -648,4 +834,5 @@ public:
 
 }; // class
 
-
+typedef VLIntN<VLUInt::MAX_LEN> VLInt;     // No limit
+typedef VLIntN<13> VLIntFixed;              // The widest fixed width, 2^416 (10^125), cube root = 10^41
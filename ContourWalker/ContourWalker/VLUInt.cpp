@@ -1,5 +1 @@
 #include "VLUInt.h"
-
-std::vector<VLUInt> VLUInt::powers2 = { VLUInt(1) };
-
-
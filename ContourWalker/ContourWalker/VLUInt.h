@@ -5,39 +5,408 @@
 #include <iomanip>
 #include <iostream>
 #include <sstream>
-
-class VLUInt
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+#include "Platform.h"
+#include "LimbStore.h"
+
+//-------------------------------------------------------------------------------------------------
+// Unsigned big integer with room for N limbs. Smaller instantiations have smaller copies and, at
+// or below FIXED_LEN limbs, add, subtract and compare run over every limb so that the compiler can
+// unroll them. Anything that would need more than N limbs throws std::overflow_error.
+//
+// VLUIntN<0> has no limit, it keeps FIXED_LEN limbs in place and grows onto the heap past that
+// (see LimbStore). VLUInt is this one.
+//-------------------------------------------------------------------------------------------------
+
+template <int N>
+class VLUIntN
 {
-    // Base = 100 million, I want to work in powers of 10 so I'm doing the maths base 10^n, makes printing and debugging easier
+    // Base = 2^32, the limbs are binary so that add, subtract and multiply never need a divide, products and
+    // carries fit in 64 bits. Decimal (base 10^8) is only used when printing.
+
+    static_assert(N == 0 || N >= 2, "VLUIntN needs at least 2 limbs to hold an __int64");
+
+    template <int M> friend class VLUIntN;
+    friend class MultiplyBenchmark;
+    template <class, template <class> class> friend class LaneWalkerT;
+
+    typedef VLLimb Limb;
+    typedef uint64_t Wide;
+
+    static const int BITS = 32;
+    static const int FIXED_LEN = 4;
+    static const bool UNROLL = N > 0 && N <= FIXED_LEN;
+    static const bool GROWS = LimbStore<N>::GROWS;
+    static const Wide BASE = (Wide)1 << BITS;
 
     static const int DIGITS = 8;
-    //static const int MAX_LEN = 60;  // 10^480
-    static const int MAX_LEN = 15;  // 10^120, cube root = 10^40
-    static const __int64 BASE = 100000000; // 10^DIGITS
+    static const Limb DECIMAL_BASE = 100000000; // 10^DIGITS
 
-    static std::vector<VLUInt> powers2;
+    static const int KARATSUBA_LIMBS = 32;      // Karatsuba pays for itself from here (see MultiplyBenchmark)
+    static const int TEST_LEN = N ? N : 64;     // How far the tests go, far enough for Karatsuba without a limit
 
-    __int64 value[MAX_LEN]{ 0 };    // [0] is the least significant digit
+    LimbStore<N> value;     // [0] is the least significant digit, digits at or above length are always 0
     int length{ 0 };
 
+    //--------------------------------------------------------------------------------------------
+    inline void Trim()
+    {
+        while (length > 0 && value[length - 1] == 0)
+        {
+            --length;
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    inline static void CheckLength(int len)
+    {
+        if (! GROWS && len > N)
+        {
+            throw std::overflow_error("VLUInt overflow");
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Converts to base 10^DIGITS, least significant first, returns the number of decimal digits
+    //--------------------------------------------------------------------------------------------
+    inline int ToDecimal(Limb * digits) const
+    {
+        int num_digits = 0;
+        VLUIntN temp = (*this);
+
+        temp.Trim();
+
+        while (temp.length > 0)
+        {
+            Wide rem = 0;
+
+            for (int i = temp.length - 1; i >= 0; --i)
+            {
+                Wide v = (rem << BITS) | temp.value[i];
+
+                temp.value[i] = (Limb) (v / DECIMAL_BASE);
+                rem = v % DECIMAL_BASE;
+            }
+            temp.Trim();
+            digits[num_digits++] = (Limb) rem;
+        }
+        return num_digits;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Remainder after dividing by a single limb
+    //--------------------------------------------------------------------------------------------
+    inline int SmallMod(Limb number) const
+    {
+        Wide rem = 0;
+
+        for (int i = length - 1; i >= 0; --i)
+        {
+            rem = ((rem << BITS) | value[i]) % number;
+        }
+        return (int)rem;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Multiplication kernels, on limb arrays so that Karatsuba can work on parts of a number.
+    // r needs la + lb limbs and mustn't overlap a or b.
+    //--------------------------------------------------------------------------------------------
+    // Comba, works out the product a column at a time. Each column is summed in a 64 bit
+    // accumulator plus a count of its carries, so every result limb is written once.
+    inline static void MulComba(const Limb * a, int la, const Limb * b, int lb, Limb * r)
+    {
+        Wide acc = 0;
+
+        for (int k = 0; k < la + lb - 1; ++k)
+        {
+            Wide high = 0;
+            int first = (k < lb) ? 0 : k - lb + 1;
+            int last = (k < la) ? k : la - 1;
+
+            for (int i = first; i <= last; ++i)
+            {
+                Wide p = (Wide) a[i] * b[k - i];
+
+                acc += p;
+                high += (acc < p) ? 1 : 0;
+            }
+
+            r[k] = (Limb) acc;
+            acc = (acc >> BITS) | (high << BITS);
+        }
+
+        r[la + lb - 1] = (Limb) acc;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Comba squaring, the products a[i] * a[j] and a[j] * a[i] are the same so each column sums
+    // the ones with i < j, doubles them and adds the square on the diagonal. About half the
+    // multiplies of MulComba.
+    inline static void SquareComba(const Limb * a, int la, Limb * r)
+    {
+        Wide acc = 0;
+        Wide high = 0;      // Carries out of acc
+
+        for (int k = 0; k < 2 * la - 1; ++k)
+        {
+            Wide col = 0;
+            Wide col_high = 0;
+            int first = (k < la) ? 0 : k - la + 1;
+
+            for (int i = first; i < k - i; ++i)
+            {
+                Wide p = (Wide) a[i] * a[k - i];
+
+                col += p;
+                col_high += (col < p) ? 1 : 0;
+            }
+
+            col_high = (col_high << 1) | (col >> 63);
+            col <<= 1;
+
+            if (k % 2 == 0)
+            {
+                Wide d = (Wide) a[k / 2] * a[k / 2];
+
+                col += d;
+                col_high += (col < d) ? 1 : 0;
+            }
+
+            acc += col;
+            high += col_high + ((acc < col) ? 1 : 0);
+
+            r[k] = (Limb) acc;
+            acc = (acc >> BITS) | (high << BITS);
+            high >>= BITS;
+        }
+
+        r[2 * la - 1] = (Limb) acc;
+    }
+    //--------------------------------------------------------------------------------------------
+    // r[0..n) += a[0..la), returns the carry out of the top
+    inline static Limb AddLimbs(Limb * r, int n, const Limb * a, int la)
+    {
+        Wide carry = 0;
+
+        for (int i = 0; i < n && (i < la || carry != 0); ++i)
+        {
+            Wide sum = carry + r[i] + ((i < la) ? a[i] : 0);
+
+            r[i] = (Limb) sum;
+            carry = sum >> BITS;
+        }
+        return (Limb) carry;
+    }
+    //--------------------------------------------------------------------------------------------
+    // r[0..n) -= a[0..la), returns the borrow out of the top, which is 1 if r was smaller
+    inline static Limb SubLimbs(Limb * r, int n, const Limb * a, int la)
+    {
+        Wide borrow = 0;
+
+        for (int i = 0; i < n && (i < la || borrow != 0); ++i)
+        {
+            Wide sub = borrow + ((i < la) ? a[i] : 0);
+
+            borrow = (r[i] < sub) ? 1 : 0;
+            r[i] = (Limb) (r[i] - sub);
+        }
+        return (Limb) borrow;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Karatsuba, for two n limb numbers split into halves, a = a1 B^m + a0 and b = b1 B^m + b0:
+    // ab = z2 B^2m + z1 B^m + z0 with z0 = a0 b0, z2 = a1 b1 and z1 = (a0 + a1)(b0 + b1) - z0 - z2,
+    // three half size products instead of four. r needs 2n limbs, scratch KaratsubaScratch(n).
+    inline static void MulKaratsuba(const Limb * a, const Limb * b, int n, Limb * r, Limb * scratch)
+    {
+        if (n < KARATSUBA_LIMBS)
+        {
+            if (a == b)
+                SquareComba(a, n, r);
+            else
+                MulComba(a, n, b, n, r);
+            return;
+        }
+
+        int m = n / 2;
+        int h = n - m;      // High halves, h >= m
+
+        Limb * sa = scratch;            // a0 + a1, h + 1 limbs
+        Limb * sb = sa + h + 1;         // b0 + b1, h + 1 limbs, the same as sa when squaring
+        Limb * z1 = sb + h + 1;         // 2h + 2 limbs
+        Limb * next = z1 + 2 * h + 2;
+
+        ::memcpy(sa, a + m, h * sizeof(Limb));
+        sa[h] = AddLimbs(sa, h, a, m);
+
+        if (a == b)
+        {
+            sb = sa;
+        }
+        else
+        {
+            ::memcpy(sb, b + m, h * sizeof(Limb));
+            sb[h] = AddLimbs(sb, h, b, m);
+        }
+
+        // z0 and z2 fill r between them
+
+        MulKaratsuba(a, b, m, r, next);
+        MulKaratsuba(a + m, b + m, h, r + 2 * m, next);
+        MulKaratsuba(sa, sb, h + 1, z1, next);
+
+        SubLimbs(z1, 2 * h + 2, r, 2 * m);
+        SubLimbs(z1, 2 * h + 2, r + 2 * m, 2 * h);
+        AddLimbs(r + m, 2 * n - m, z1, std::min(2 * h + 2, 2 * n - m));
+    }
+    //--------------------------------------------------------------------------------------------
+    // Limbs of scratch space MulKaratsuba needs for n limbs
+    inline static constexpr int KaratsubaScratch(int n)
+    {
+        return (n < KARATSUBA_LIMBS) ? 0 : 4 * (n - n / 2) + 4 + KaratsubaScratch(n - n / 2 + 1);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Copies a product into a VLUIntN, throws if it doesn't fit
+    inline static VLUIntN FromProduct(const Limb * r, int len)
+    {
+        VLUIntN ret;
+
+        while (len > 0 && r[len - 1] == 0)
+        {
+            --len;
+        }
+
+        ret.value.Reserve(len);
+        ret.length = len;
+        ::memcpy(ret.value, r, len * sizeof(Limb));
+
+        return ret;
+    }
+
+    //--------------------------------------------------------------------------------------------
+    // Knuth's Algorithm D (TAOCP 4.3.1), u / v for lu >= lv >= 2 and v[lv - 1] != 0. Shifts both
+    // so that the top bit of v is set, then each quotient limb is guessed from the top two limbs
+    // of the remainder and the top limb of v, corrected with the next limb down (the guess is
+    // then at most one too big) and fixed up by adding v back in the rare case it still is.
+    // q needs lu - lv + 1 limbs, r needs lv.
+    inline static void DivKnuth(const Limb * u, int lu, const Limb * v, int lv, Limb * q, Limb * r)
+    {
+        LimbBuffer<N> vn(lv);
+        LimbBuffer<N ? N + 1 : 0> un(lu + 1);
+        int shift = 0;
+
+        for (Limb top = v[lv - 1]; (top & ((Limb) 1 << (BITS - 1))) == 0; top <<= 1)
+        {
+            ++shift;
+        }
+
+        for (int i = lv - 1; i > 0; --i)
+        {
+            vn[i] = (v[i] << shift) | (shift ? v[i - 1] >> (BITS - shift) : 0);
+        }
+        vn[0] = v[0] << shift;
+
+        un[lu] = shift ? u[lu - 1] >> (BITS - shift) : 0;
+
+        for (int i = lu - 1; i > 0; --i)
+        {
+            un[i] = (u[i] << shift) | (shift ? u[i - 1] >> (BITS - shift) : 0);
+        }
+        un[0] = u[0] << shift;
+
+        for (int j = lu - lv; j >= 0; --j)
+        {
+            Wide top = ((Wide) un[j + lv] << BITS) | un[j + lv - 1];
+            Wide qhat = top / vn[lv - 1];
+            Wide rhat = top % vn[lv - 1];
+
+            while (qhat >= BASE || qhat * vn[lv - 2] > ((rhat << BITS) | un[j + lv - 2]))
+            {
+                --qhat;
+                rhat += vn[lv - 1];
+
+                if (rhat >= BASE) break;
+            }
+
+            // un[j..j+lv] -= qhat * vn
+
+            int64_t borrow = 0;
+            int64_t t;
+
+            for (int i = 0; i < lv; ++i)
+            {
+                Wide p = qhat * vn[i];
+
+                t = un[i + j] - borrow - (int64_t) (p & (BASE - 1));
+                un[i + j] = (Limb) t;
+                borrow = (int64_t) (p >> BITS) - (t >> BITS);
+            }
+            t = un[j + lv] - borrow;
+            un[j + lv] = (Limb) t;
+
+            q[j] = (Limb) qhat;
+
+            if (t < 0)
+            {
+                // One too many, add v back
+
+                Wide carry = 0;
+
+                --q[j];
+
+                for (int i = 0; i < lv; ++i)
+                {
+                    Wide sum = (Wide) un[i + j] + vn[i] + carry;
+
+                    un[i + j] = (Limb) sum;
+                    carry = sum >> BITS;
+                }
+                un[j + lv] = (Limb) (un[j + lv] + carry);
+            }
+        }
+
+        for (int i = 0; i < lv; ++i)
+        {
+            r[i] = (un[i] >> shift) | (shift ? un[i + 1] << (BITS - shift) : 0);
+        }
+    }
+
 public:
 
+    static const int MAX_LEN = N;
+
+    //--------------------------------------------------------------------------------------------
+    // Bytes moved by copies so far, only counted in builds with VLINT_COUNT_COPIES defined so
+    // that normal builds don't pay for it (see StepBenchmark)
+    inline static __int64& CopiedBytes()
+    {
+        static __int64 bytes = 0;
+        return bytes;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline static void CountCopy(int len)
+    {
+#ifdef VLINT_COUNT_COPIES
+        CopiedBytes() += GROWS ? len * sizeof(Limb) : sizeof(VLUIntN);
+#else
+        (void) len;
+#endif
+    }
+
     // TODO make this debug only
 
     inline static void CheckNegative(__int64 n)
     {
         if (n < 0)
         {
-            throw std::exception("negative argument for unsigned not supported");
+            throw std::runtime_error("negative argument for unsigned not supported");
         }
     }
 
     //----------------------------------------------------------------------------------------------------------------
-    inline VLUInt()
+    inline VLUIntN()
     {
     }
     //----------------------------------------------------------------------------------------------------------------
-    inline VLUInt (__int64 n)
+    inline VLUIntN (__int64 n)
     {
         length = 0;
 
@@ -45,45 +414,91 @@ public:
 
         do
         {
-            value[length] = n % BASE;
+            value[length] = (Limb)n;
             length++;
-            n = n / BASE;
+            n = n >> BITS;
         } while (n > 0);
     }
     //--------------------------------------------------------------------------------------------
-    inline VLUInt (const VLUInt& other)
+    inline VLUIntN (const VLUIntN& other)
+        : length (other.length)
+    {
+        value.Assign(other.value, other.length, 0);
+        CountCopy(length);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Only VLUIntN<0> can move its limbs, the others copy
+    inline VLUIntN (VLUIntN&& other)
         : length (other.length)
     {
-        ::memcpy(value, other.value, sizeof(value));
+        if (value.Take(other.value, other.length, 0))
+        {
+            other.length = 0;
+        }
+        else
+        {
+            CountCopy(length);
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Convert from a different width
+    //--------------------------------------------------------------------------------------------
+    template <int M>
+    inline explicit VLUIntN (const VLUIntN<M>& other)
+        : length (other.length)
+    {
+        value.Reserve(other.length);
+        ::memcpy(value, other.value, other.length * sizeof(Limb));
     }
     //--------------------------------------------------------------------------------------------
     inline bool TestSmall(int target) const
     {
-        return length == 1 && value [0] < target;
+        return length == 1 && value [0] < (Limb) target;
     }
     //--------------------------------------------------------------------------------------------
-    inline VLUInt& operator = (const VLUInt& other)
+    inline VLUIntN& operator = (const VLUIntN& other)
     {
         if (this != &other)
         {
-            ::memcpy(value, other.value, sizeof(value));
+            value.Assign(other.value, other.length, length);
             length = other.length;
+            CountCopy(length);
         }
 
         return (*this);
     }
     //--------------------------------------------------------------------------------------------
-    inline VLUInt& operator = (__int64 n)
+    inline VLUIntN& operator = (VLUIntN&& other)
     {
-        length = 0;
+        if (this != &other)
+        {
+            if (value.Take(other.value, other.length, length))
+            {
+                length = other.length;
+                other.length = 0;
+            }
+            else
+            {
+                length = other.length;
+                CountCopy(length);
+            }
+        }
 
+        return (*this);
+    }
+    //--------------------------------------------------------------------------------------------
+    inline VLUIntN& operator = (__int64 n)
+    {
         CheckNegative(n);
 
+        value.Clear(length);
+        length = 0;
+
         do
         {
-            value[length] = n % BASE;
+            value[length] = (Limb)n;
             length++;
-            n = n / BASE;
+            n = n >> BITS;
         } while (n > 0);
 
         return (*this);
@@ -93,104 +508,154 @@ public:
     //--------------------------------------------------------------------------------------------
     // Multiply by a simple integer
     //--------------------------------------------------------------------------------------------
-    inline VLUInt operator * (__int64 num) const
+    inline VLUIntN operator * (__int64 num) const
     {
         if (num == 0 || IsZero())
         {
-            return VLUInt(0);
+            return VLUIntN(0);
         }
 
         CheckNegative(num);
 
-        VLUInt ret; 
-        __int64 carry = 0;
+        if ((Wide) num >= BASE)
+        {
+            return (*this) * VLUIntN(num);
+        }
+
+        VLUIntN ret;
+        Wide carry = 0;
 
+        ret.value.Reserve(length);
         ret.length = length;
 
         for (auto i = 0; i < ret.length; ++i)
         {
-            auto v = value[i] * num + carry;
-            carry = v / BASE;
-            ret.value[i] = v % BASE;
+            auto v = value[i] * (Wide) num + carry;
+            carry = v >> BITS;
+            ret.value[i] = (Limb) v;
         }
 
-        while (carry > 0)
+        if (carry > 0)
         {
-            ret.value[ret.length] = carry % BASE;
+            ret.value.Reserve(ret.length + 1);
+            ret.value[ret.length] = (Limb) carry;
             ret.length++;
-            carry = carry / BASE;
         }
 
         return ret;
     }
     //--------------------------------------------------------------------------------------------
-    // Multiply by a another big integer
+    // Multiply by a another big integer. Comba below KARATSUBA_LIMBS, Karatsuba above it when the
+    // two are about the same size. Squares go through Square.
     //--------------------------------------------------------------------------------------------
-    inline VLUInt operator * (const VLUInt& other) const
+    inline VLUIntN operator * (const VLUIntN& other) const
     {
         if (other.IsZero() || IsZero())
         {
-            return VLUInt(0);
+            return VLUIntN(0);
+        }
+
+        if (&other == this)
+        {
+            return Square();
         }
 
-        VLUInt ret;
         auto len1 = length;
         auto len2 = other.length;
-        auto len = len1 + len2;
 
-        for (auto i = 0; i < len1; ++i)
+        CheckLength(len1 + len2 - 1);
+
+        auto n = std::max(len1, len2);
+        LimbBuffer<2 * N> r(2 * n);
+
+        if (n >= KARATSUBA_LIMBS && std::min(len1, len2) * 2 > n)
         {
-            auto v1 = value[i];
+            LimbBuffer<N> a(n);
+            LimbBuffer<N> b(n);
+            LimbBuffer<N ? KaratsubaScratch(N) + 1 : 0> scratch(KaratsubaScratch(n) + 1);
 
-            for (auto j = 0; j < len2; ++j)
-            {
-                auto v2 = v1 * other.value[j];
-                auto pos = i + j;
-                ret.value[pos] += v2;
-            }
+            ::memcpy(a, value, len1 * sizeof(Limb));
+            ::memset(a + len1, 0, (n - len1) * sizeof(Limb));
+            ::memcpy(b, other.value, len2 * sizeof(Limb));
+            ::memset(b + len2, 0, (n - len2) * sizeof(Limb));
+
+            MulKaratsuba(a, b, n, r, scratch);
+            return FromProduct(r, 2 * n);
         }
 
-        for (int i = 0 ; i < len-1 ; ++i)
+        MulComba(value, len1, other.value, len2, r);
+        return FromProduct(r, len1 + len2);
+    }
+    //--------------------------------------------------------------------------------------------
+    // The old row by row product, kept as the reference for the tests and the benchmark
+    //--------------------------------------------------------------------------------------------
+    inline VLUIntN MulSchoolbook(const VLUIntN& other) const
+    {
+        if (other.IsZero() || IsZero())
         {
-            ret.value[i + 1] += ret.value[i] / BASE;
-            ret.value[i] %= BASE;
+            return VLUIntN(0);
         }
 
-        if (ret.value[len - 1] > 0)
+        VLUIntN ret;
+        auto len1 = length;
+        auto len2 = other.length;
+
+        ret.value.Reserve(len1 + len2 - 1);
+
+        if (GROWS)
         {
-            ++len;
+            ret.value.Reserve(len1 + len2);
         }
 
-        ret.length = len;
-
-        while (ret.length > 0 && ret.value[ret.length-1] == 0)
+        for (auto i = 0; i < len1; ++i)
         {
-            --ret.length;
+            Wide v1 = value[i];
+            Wide carry = 0;
+
+            for (auto j = 0; j < len2; ++j)
+            {
+                auto pos = i + j;
+                auto v2 = v1 * other.value[j] + ret.value[pos] + carry;
+
+                ret.value[pos] = (Limb) v2;
+                carry = v2 >> BITS;
+            }
+
+            if (i + len2 < ret.value.Capacity())
+            {
+                ret.value[i + len2] = (Limb) carry;
+            }
+            else if (carry > 0)
+            {
+                CheckLength(i + len2 + 1);
+            }
         }
 
+        ret.length = std::min(len1 + len2, ret.value.Capacity());
+        ret.Trim();
+
         return ret;
     }
     //--------------------------------------------------------------------------------------------
     // Add a simple number (this number is truncated to an integer)
     //--------------------------------------------------------------------------------------------
-    inline VLUInt operator + (__int64 num) const
+    inline VLUIntN operator + (__int64 num) const
     {
         CheckNegative(num);
 
-        VLUInt ret;
+        VLUIntN ret;
+        Wide carry = (Wide) num;
 
-        ret.value[0] = value[0] + num;
-        auto carry = ret.value[0] / BASE;
-        ret.value[0] %= BASE;
+        ret.value.Reserve(length);
         ret.length = length;
 
-        for (int i = 1; i < length; ++i)
+        for (int i = 0; i < length; ++i)
         {
             if (carry > 0)
             {
-                ret.value[i] = value [i] + carry;
-                carry = ret.value[i] / BASE;
-                ret.value[i] %= BASE;
+                auto sum = value[i] + carry;
+                ret.value[i] = (Limb) sum;
+                carry = sum >> BITS;
             }
             else
             {
@@ -200,8 +665,10 @@ public:
 
         while (carry > 0)
         {
-            ret.value[ret.length] = carry % BASE;
-            carry /= BASE;
+            ret.value.Reserve(ret.length + 1);
+            ret.value[ret.length] = (Limb) carry;
+            ret.length++;
+            carry = carry >> BITS;
         }
 
         return ret;
@@ -209,18 +676,18 @@ public:
     //--------------------------------------------------------------------------------------------
     // Subtract a simple number
     //--------------------------------------------------------------------------------------------
-    inline VLUInt operator - (__int64 num) const
+    inline VLUIntN operator - (__int64 num) const
     {
         CheckNegative(num);
 
-        VLUInt n(num);
+        VLUIntN n(num);
 
         return (*this) - n;
     }
     //--------------------------------------------------------------------------------------------
     // Pre increment
     //--------------------------------------------------------------------------------------------
-    inline VLUInt& operator ++ ()
+    inline VLUIntN& operator ++ ()
     {
         if (IsZero())
         {
@@ -229,28 +696,26 @@ public:
             return (*this);
         }
 
-        ++value[0];
-
-        for (auto i = 0; i < (length-1) && value[i] == BASE; ++i)
+        for (auto i = 0; i < length; ++i)
         {
-            value[i] = 0;
-            ++value[i + 1];
+            if (++value[i] != 0)    // No wrap, so no carry
+            {
+                return (*this);
+            }
         }
 
-        if (value[length-1] == BASE)
-        {
-            value[length - 1] = 0;
-            value[length] = 1;
-            length++;
-        }
+        value.Reserve(length + 1);
+        value[length] = 1;
+        length++;
+
         return (*this);
     }
     //--------------------------------------------------------------------------------------------
     // Post increment
     //--------------------------------------------------------------------------------------------
-    inline VLUInt operator ++ (int)
+    inline VLUIntN operator ++ (int)
     {
-        VLUInt temp (*this);
+        VLUIntN temp (*this);
 
         ++(*this);
         return temp;
@@ -258,29 +723,31 @@ public:
     //--------------------------------------------------------------------------------------------
     // Pre decrement
     //--------------------------------------------------------------------------------------------
-    inline VLUInt & operator -- ()
+    inline VLUIntN & operator -- ()
     {
         if (IsZero())
         {
-            throw std::exception("Can't decrement zero");
+            throw std::runtime_error("Can't decrement zero");
         }
 
-        --value[0];
-
-        for (auto i = 0; i < (length-1) && value[i] < 0; ++i)
+        for (auto i = 0; i < length; ++i)
         {
-            value[i] = BASE - 1;
-            --value[i + 1];
+            if (value[i]-- != 0)    // No wrap, so no borrow
+            {
+                break;
+            }
         }
 
+        Trim();
+
         return (*this);
     }
     //--------------------------------------------------------------------------------------------
     // Post decrement
     //--------------------------------------------------------------------------------------------
-    inline VLUInt operator -- (int)
+    inline VLUIntN operator -- (int)
     {
-        VLUInt temp (* this);
+        VLUIntN temp (* this);
 
         --(*this);
         return temp;
@@ -288,32 +755,41 @@ public:
     //--------------------------------------------------------------------------------------------
     // Add
     //--------------------------------------------------------------------------------------------
-    inline VLUInt operator + (const VLUInt& other) const
+    inline VLUIntN operator + (const VLUIntN& other) const
     {
-        VLUInt ret;
+        if (GROWS)
+        {
+            VLUIntN ret(*this);     // The shorter one's limbs may not reach the longer one's length
 
-        auto len1 = length;
-        auto len2 = other.length;
-        auto len = std::max(len1, len2);
+            ret += other;
+            return ret;
+        }
+
+        VLUIntN ret;
 
-        __int64 carry = 0;
+        auto len = std::max(length, other.length);
+        auto top = UNROLL ? N : len;      // Small numbers use every limb so that the loop unrolls
 
-        for (auto i = 0; i < len; ++i)
+        Wide carry = 0;
+
+        for (auto i = 0; i < top; ++i)
         {
-            __int64 sum = carry;
+            Wide sum = carry + value[i] + other.value[i];
 
-            if (i < len1) sum += value[i];
-            if (i < len2) sum += other.value[i];
+            ret.value[i] = (Limb) sum;
+            carry = sum >> BITS;
+        }
 
-            ret.value[i] = sum % BASE;
-            carry = sum / BASE;
+        if (carry > 0)
+        {
+            CheckLength(top + 1);
+            ret.value[top] = (Limb) carry;
         }
 
         ret.length = len;
 
-        if (carry > 0)
+        if (len < ret.value.Capacity() && ret.value[len] != 0)
         {
-            ret.value[ret.length] = carry;
             ++ret.length;
         }
         return ret;
@@ -321,55 +797,197 @@ public:
     //--------------------------------------------------------------------------------------------
     // Subtract
     //--------------------------------------------------------------------------------------------
-    inline VLUInt operator - (const VLUInt& other) const
+    inline VLUIntN operator - (const VLUIntN& other) const
     {
-        VLUInt ret;
+        if (GROWS)
+        {
+            VLUIntN ret(*this);
+
+            ret -= other;
+            return ret;
+        }
+
+        VLUIntN ret;
 
         // Expects vec1 >= vec2
 
         if (other.length > length)
         {
-            throw std::exception("Subtraction would result in negative result");
+            throw std::runtime_error("Subtraction would result in negative result");
         }
 
-        __int64 carry = 0;
-        int len = 0;
+        auto top = UNROLL ? N : length;
+
+        Wide borrow = 0;
+
+        for (int i = 0; i < top ; ++i)
+        {
+            Wide sub = borrow + other.value[i];
+
+            ret.value[i] = (Limb) (value[i] - sub);
+            borrow = (value[i] < sub) ? 1 : 0;
+        }
+
+        if (borrow > 0)
+        {
+            throw std::runtime_error("Subtraction would result in negative result");
+        }
 
         ret.length = length;
+        ret.Trim();
 
-        for (int i = 0; i < length ; ++i)
+        return ret;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Add in place, the walkers' increments use these so that no temporary gets built and copied
+    //--------------------------------------------------------------------------------------------
+    inline VLUIntN& operator += (const VLUIntN& other)
+    {
+        auto len = std::max(length, other.length);
+
+        if (GROWS)
         {
-            auto sub = (i < other.length) ? other.value[i] : 0;
-            auto diff = carry + value [i] - sub;
+            value.Reserve(len);
+
+            auto carry = AddLimbs(value, len, other.value, other.length);
+
+            length = len;
 
-            if (diff < 0)
+            if (carry != 0)
             {
-                diff += BASE;
-                carry = -1;
+                value.Reserve(len + 1);
+                value[length++] = carry;
             }
-            else
+            return (*this);
+        }
+
+        auto top = UNROLL ? N : len;
+
+        Wide carry = 0;
+
+        for (auto i = 0; i < top; ++i)
+        {
+            Wide sum = carry + value[i] + other.value[i];
+
+            value[i] = (Limb) sum;
+            carry = sum >> BITS;
+        }
+
+        if (carry > 0)
+        {
+            CheckLength(top + 1);
+            value[top] = (Limb) carry;
+        }
+
+        length = len;
+
+        if (len < value.Capacity() && value[len] != 0)
+        {
+            ++length;
+        }
+        return (*this);
+    }
+    //--------------------------------------------------------------------------------------------
+    // Subtract in place, expects this >= other
+    //--------------------------------------------------------------------------------------------
+    inline VLUIntN& operator -= (const VLUIntN& other)
+    {
+        if (other.length > length)
+        {
+            throw std::runtime_error("Subtraction would result in negative result");
+        }
+
+        if (GROWS)
+        {
+            if (SubLimbs(value, length, other.value, other.length) != 0)
             {
-                carry = 0;
+                throw std::runtime_error("Subtraction would result in negative result");
             }
-            ret.value [i] = diff;
+
+            Trim();
+            return (*this);
+        }
+
+        auto top = UNROLL ? N : length;
+
+        Wide borrow = 0;
+
+        for (int i = 0; i < top; ++i)
+        {
+            Wide sub = borrow + other.value[i];
+            Limb v = value[i];
+
+            value[i] = (Limb) (v - sub);
+            borrow = (v < sub) ? 1 : 0;
         }
 
-        if (carry < 0)
+        if (borrow > 0)
         {
-            throw std::exception("Subtraction would result in negative result");
+            throw std::runtime_error("Subtraction would result in negative result");
         }
-        
-        while (ret.length > 0 && ret.value[ret.length - 1] == 0)
+
+        Trim();
+
+        return (*this);
+    }
+    //--------------------------------------------------------------------------------------------
+    // this = other - this, in place, expects other >= this
+    //--------------------------------------------------------------------------------------------
+    inline VLUIntN& SubtractFrom(const VLUIntN& other)
+    {
+        if (length > other.length)
+        {
+            throw std::runtime_error("Subtraction would result in negative result");
+        }
+
+        if (GROWS)
+        {
+            VLUIntN ret(other);
+
+            ret -= (*this);
+            return (*this) = std::move(ret);
+        }
+
+        auto top = UNROLL ? N : other.length;
+
+        Wide borrow = 0;
+
+        for (int i = 0; i < top; ++i)
+        {
+            Wide sub = borrow + value[i];
+            Limb v = other.value[i];
+
+            value[i] = (Limb) (v - sub);
+            borrow = (v < sub) ? 1 : 0;
+        }
+
+        if (borrow > 0)
         {
-            --ret.length;
+            throw std::runtime_error("Subtraction would result in negative result");
         }
-        return ret;
+
+        length = other.length;
+        Trim();
+
+        return (*this);
     }
     //--------------------------------------------------------------------------------------------
     // Compare, returns -1, 0 or 1 for (first < second), (first == second) and (first > second)
     //--------------------------------------------------------------------------------------------
-    inline static int Compare(const VLUInt& first, const VLUInt& second)
+    inline static int Compare(const VLUIntN& first, const VLUIntN& second)
     {
+        if (UNROLL)
+        {
+            for (int i = N - 1; i >= 0; --i)
+            {
+                if (first.value[i] != second.value[i])
+                {
+                    return (first.value[i] > second.value[i]) ? 1 : -1;
+                }
+            }
+            return 0;
+        }
+
         if (first.length != second.length)
         {
             return (first.length > second.length) ? 1 : -1;
@@ -383,53 +1001,55 @@ public:
             }
         }
 
-        return 0;     
+        return 0;
     }
     //--------------------------------------------------------------------------------------------
     // returns the minimum (by reference)
     //--------------------------------------------------------------------------------------------
-    inline static const VLUInt & Min(const VLUInt& first, const VLUInt& second)
+    inline static const VLUIntN & Min(const VLUIntN& first, const VLUIntN& second)
     {
         return (Compare(first, second) > 0) ? second : first;
     }
     //--------------------------------------------------------------------------------------------
     // returns the maximum (by reference)
     //--------------------------------------------------------------------------------------------
-    inline static const VLUInt& Max(const VLUInt& first, const VLUInt& second)
+    inline static const VLUIntN& Max(const VLUIntN& first, const VLUIntN& second)
     {
         return (Compare(first, second) > 0) ? first : second;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator > (const VLUInt& other) const
+    inline bool operator > (const VLUIntN& other) const
     {
         return Compare((*this), other) > 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator >= (const VLUInt& other) const
+    inline bool operator >= (const VLUIntN& other) const
     {
         return Compare((*this), other) >= 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator < (const VLUInt& other) const
+    inline bool operator < (const VLUIntN& other) const
     {
         return Compare((*this), other) < 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator <= (const VLUInt& other) const
+    inline bool operator <= (const VLUIntN& other) const
     {
         return Compare((*this), other) <= 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator == (const VLUInt& other) const
+    inline bool operator == (const VLUIntN& other) const
     {
         return Compare((*this), other) == 0;
     }
     //--------------------------------------------------------------------------------------------
-    inline bool operator != (const VLUInt& other) const
+    inline bool operator != (const VLUIntN& other) const
     {
         return Compare((*this), other) != 0;
     }
     //--------------------------------------------------------------------------------------------
+    // Powers of 2 only need the bottom limb, the others go through SmallMod
+    //--------------------------------------------------------------------------------------------
     inline int Mod2() const
     {
         return (length > 0) ? (value[0] % 2) : 0;
@@ -437,18 +1057,7 @@ public:
     //--------------------------------------------------------------------------------------------
     inline int Mod3() const
     {
-        if (length == 0)
-        {
-            return 0;
-        }
-
-        auto sum = value[0];
-
-        for (auto i = 1; i < length; ++i)
-        {
-            sum += value[i];
-        }
-        return sum % 3;
+        return SmallMod(3);
     }
     //--------------------------------------------------------------------------------------------
     inline int Mod4() const
@@ -458,7 +1067,7 @@ public:
     //--------------------------------------------------------------------------------------------
     inline int Mod5() const
     {
-        return (length > 0) ? (value[0] % 5) : 0;
+        return SmallMod(5);
     }
     //--------------------------------------------------------------------------------------------
     inline int Mod8() const
@@ -468,23 +1077,12 @@ public:
     //--------------------------------------------------------------------------------------------
     inline int Mod9() const
     {
-        if (length == 0)
-        {
-            return 0;
-        }
-
-        auto sum = value[0];
-
-        for (auto i = 1; i < length; ++i)
-        {
-            sum += value[i];
-        }
-        return sum % 9;
+        return SmallMod(9);
     }
     //--------------------------------------------------------------------------------------------
     inline int Mod10() const
     {
-        return (length > 0) ? (value[0] % 10) : 0;
+        return SmallMod(10);
     }
     //--------------------------------------------------------------------------------------------
     inline int Mod16() const
@@ -492,48 +1090,47 @@ public:
         return (length > 0) ? (value[0] % 16) : 0;
     }
     //--------------------------------------------------------------------------------------------
-    // Divide by an integer (< BASE)
-    inline VLUInt DivideByInt(__int64 number)
+    // Divide by an integer (<= BASE)
+    inline VLUIntN DivideByInt(__int64 number) const
     {
         return DivMod(number).first;
     }
-    inline __int64 Remainder(__int64 number)
+    inline __int64 Remainder(__int64 number) const
     {
         return DivMod(number).second;
     }
 
-    inline std::pair<VLUInt, __int64> DivMod(__int64 number)
+    inline std::pair<VLUIntN, __int64> DivMod(__int64 number) const
     {
-        std::pair<VLUInt, __int64> ret;
+        std::pair<VLUIntN, __int64> ret;
 
-        if (number <= 0 || number > BASE)
+        if (number <= 0 || (Wide) number > BASE)
         {
             return ret;
         }
-        
-        VLUInt temp = (*this);
 
-        __int64 rem = 0;
+        VLUIntN temp = (*this);
+
+        Wide rem = 0;
 
         for (int i = length - 1; i >= 0; --i)
         {
-            rem = temp.value[i] % number;
+            Wide v = (rem << BITS) | temp.value[i];
 
-            temp.value[i] = temp.value[i] / number;
-
-            if (i > 0)
-            {
-                temp.value[i - 1] += BASE * rem;
-            }
+            temp.value[i] = (Limb) (v / number);
+            rem = v % number;
         }
 
+        temp.Trim();
+
         ret.first = temp;
-        ret.second = rem;
+        ret.second = (__int64) rem;
         return ret;
     }
-    // Divide, this/other, returns a VLUInt
-
-    inline VLUInt operator / (const VLUInt& other)
+    //--------------------------------------------------------------------------------------------
+    // Divide, this/other, returns the quotient and the remainder
+    //--------------------------------------------------------------------------------------------
+    inline std::pair<VLUIntN, VLUIntN> DivMod(const VLUIntN& other) const
     {
         if (other.IsZero())
         {
@@ -542,84 +1139,73 @@ public:
 
         if (other > (*this))
         {
-            return VLUInt(0);
+            return std::make_pair(VLUIntN(0), *this);
         }
 
-        auto num = (*this);
-        auto den = other;
-
-        std::vector <VLUInt> subs;
-        auto answer = VLUInt (0);
-        auto pos = 0;
+        std::pair<VLUIntN, VLUIntN> ret;
 
-        subs.emplace(subs.end(), den);
+        ret.first.value.Reserve(length);
 
-        // We will subtract out powers of 2 times the divisor
-
-        while (num > subs[pos])
+        if (other.length == 1)
         {
-            subs.emplace(subs.end(), subs[pos] * 2);        // denominator x 2^n
-            ++pos;
-        }
+            Wide rem = 0;
 
-        PreparePowers(subs.size());
-
-        while (pos >= 0)
-        {
-            if (num >= subs[pos])
+            for (int i = length - 1; i >= 0; --i)
             {
-                answer = answer + powers2[pos];
-                num = num - subs[pos];
+                Wide v = (rem << BITS) | value[i];
+
+                ret.first.value[i] = (Limb) (v / other.value[0]);
+                rem = v % other.value[0];
             }
-            --pos;
+
+            ret.first.length = length;
+            ret.first.Trim();
+            ret.second = VLUIntN((__int64) rem);
+            return ret;
         }
 
-        return answer;
-    }
+        ret.second.value.Reserve(other.length);
+        DivKnuth(value, length, other.value, other.length, ret.first.value, ret.second.value);
 
-    // Saves recalculating these every time we do a division
+        ret.first.length = length - other.length + 1;
+        ret.second.length = other.length;
+        ret.first.Trim();
+        ret.second.Trim();
 
-    inline static void PreparePowers(size_t n)
+        return ret;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline VLUIntN operator / (const VLUIntN& other) const
     {
-        auto len = powers2.size();
-
-        if (n > len)
-        {
-            for (auto i = powers2.size(); i < n; ++i)
-            {
-                powers2.emplace(powers2.end(), powers2[i - 1] * 2);    // 2^n
-            }
-        }
+        return DivMod(other).first;
+    }
+    //--------------------------------------------------------------------------------------------
+    inline VLUIntN operator % (const VLUIntN& other) const
+    {
+        return DivMod(other).second;
     }
 
     //------------------------------------------------------------------------------------------------------
     // Calculates this^n (n is a positive integer, doesn't do fractional or negative powers)
 
-    inline VLUInt Pow(int n)
+    inline VLUIntN Pow(int n)
     {
-        if (n < 1) return VLUInt(1);
+        if (n < 1) return VLUIntN(1);
 
-        std::vector<VLUInt> bits;
+        VLUIntN ret(1);
         auto p = (*this);
 
         while (true)
         {
             if (n % 2 == 1)
             {
-                bits.emplace(bits.end(), p);
+                ret = ret * p;
             }
             n = n / 2;
 
             if (n < 1) break;
 
-            p = p * p;
-        }
-
-        auto ret = bits[0];
-
-        for (auto i = 1; i < bits.size(); ++i)
-        {
-            ret = ret * bits[i];
+            p = p.Square();
         }
 
         return ret;
@@ -634,16 +1220,18 @@ public:
             throw std::invalid_argument("Log 0");
         }
 
-        auto exponent = DIGITS * length;
-        double mantissa = (double)value[length - 1] / BASE;
+        LimbBuffer<2 * N> digits(2 * length);
+        auto len = ToDecimal(digits);
+        auto exponent = DIGITS * len;
+        double mantissa = (double)digits[len - 1] / DECIMAL_BASE;
 
-        if (length > 1)
+        if (len > 1)
         {
-            mantissa += (double)value[length - 2] / BASE / BASE;
+            mantissa += (double)digits[len - 2] / DECIMAL_BASE / DECIMAL_BASE;
 
-            if (length > 2)
+            if (len > 2)
             {
-                mantissa += (double)value[length - 3] / BASE / BASE / BASE;
+                mantissa += (double)digits[len - 3] / DECIMAL_BASE / DECIMAL_BASE / DECIMAL_BASE;
             }
         }
 
@@ -653,7 +1241,7 @@ public:
             exponent--;
         }
 
-        return std::make_pair(mantissa, (int)exponent);
+        return std::make_pair(mantissa, exponent);
     }
     //------------------------------------------------------------------------------------------------------
     // Log base 10
@@ -664,7 +1252,7 @@ public:
         return me.second + log10(me.first);
     }
     //------------------------------------------------------------------------------------------------------
-    inline static double Ratio(const VLUInt& b1, const VLUInt& b2)
+    inline static double Ratio(const VLUIntN& b1, const VLUIntN& b2)
     {
         auto m1 = b1.MantissaExponent();
         auto m2 = b2.MantissaExponent();
@@ -672,14 +1260,33 @@ public:
         return (m1.first / m2.first) * pow(10, (m1.second - m2.second));
     }
     //------------------------------------------------------------------------------------------------------
-    inline VLUInt Square() const
+    inline VLUIntN Square() const
     {
-        return (*this) * (*this);
+        if (IsZero())
+        {
+            return VLUIntN(0);
+        }
+
+        CheckLength(2 * length - 1);
+
+        LimbBuffer<2 * N> r(2 * length);
+
+        if (length >= KARATSUBA_LIMBS)
+        {
+            LimbBuffer<N ? KaratsubaScratch(N) + 1 : 0> scratch(KaratsubaScratch(length) + 1);
+
+            MulKaratsuba(value, value, length, r, scratch);
+        }
+        else
+        {
+            SquareComba(value, length, r);
+        }
+        return FromProduct(r, 2 * length);
     }
     //------------------------------------------------------------------------------------------------------
-    inline VLUInt Cube() const
+    inline VLUIntN Cube() const
     {
-        return (*this) * (*this) * (*this);
+        return Square() * (*this);
     }
     //------------------------------------------------------------------------------------------------------
     inline double CubeRoot() const
@@ -695,49 +1302,208 @@ public:
         return pow(me.first, 1.0 / 3.0) * pow(10, me.second / 3);
     }
     //------------------------------------------------------------------------------------------------------
+    // Limbs in use, least significant first
+    inline int Length() const
+    {
+        return length;
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline Limb GetLimb(int i) const
+    {
+        return value[i];
+    }
+    //------------------------------------------------------------------------------------------------------
+    // Number of bits needed to hold the value, 0 for 0
+    inline int BitLength() const
+    {
+        if (IsZero())
+        {
+            return 0;
+        }
+
+        int bits = length * BITS;
+
+        for (Limb mask = (Limb)1 << (BITS - 1); (value[length - 1] & mask) == 0; mask >>= 1)
+        {
+            --bits;
+        }
+        return bits;
+    }
+    //------------------------------------------------------------------------------------------------------
+    // Exact nth root, rounded down, and what's left over, this = root^n + remainder.
+    //
+    // Newton's method, x' = ((n - 1)x + this / x^(n-1)) / n, starting from the power of 2 just
+    // above the root. From above the root every step goes down, and the first one that doesn't
+    // leaves x on the root. Works in twice the width so that x^(n-1) can't overflow, and stops
+    // building it once it's bigger than this as the quotient is then 0.
+    inline std::pair<VLUIntN, VLUIntN> IRootRem(int n) const
+    {
+        if (n < 1)
+        {
+            throw std::invalid_argument("IRoot: n must be at least 1");
+        }
+
+        int bits = BitLength();
+
+        if (n == 1 || bits == 0)
+        {
+            return std::make_pair(*this, VLUIntN(0));
+        }
+
+        if (n >= bits)
+        {
+            return std::make_pair(VLUIntN(1), (*this) - 1);     // 2^n > this
+        }
+
+        typedef VLUIntN<2 * N> Wider;
+
+        Wider target(*this);
+        Wider x(0);
+        int top = (bits + n - 1) / n;
+
+        x.value.Reserve(top / BITS + 1);
+        x.value[top / BITS] = (Limb)1 << (top % BITS);
+        x.length = top / BITS + 1;
+
+        while (true)
+        {
+            Wider p(x);
+
+            for (int i = 2; i < n && p <= target; ++i)
+            {
+                p = p * x;
+            }
+
+            auto next = (x * (n - 1) + target.DivMod(p).first).DivideByInt(n);
+
+            if (next >= x) break;
+
+            x = next;
+        }
+
+        VLUIntN root(x);
+
+        return std::make_pair(root, (*this) - root.Pow(n));
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline VLUIntN IRoot(int n) const
+    {
+        return IRootRem(n).first;
+    }
+    //------------------------------------------------------------------------------------------------------
+    // Exact cube root, rounded down
+    inline VLUIntN ICbrt() const
+    {
+        return IRootRem(3).first;
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline std::pair<VLUIntN, VLUIntN> ICbrtRem() const
+    {
+        return IRootRem(3);
+    }
+    //------------------------------------------------------------------------------------------------------
     // Don't define operator so that we don't call this by mistake
     inline __int64 ToInt() const
     {
-        if (length == 0) return 0;
+        static const Wide max_int = (Wide) std::numeric_limits<__int64>::max();
 
-        auto ret = value[0];
+        Wide ret = 0;
 
-        for (auto i = 1; i < length; ++i)
+        for (auto i = length - 1; i >= 0; --i)
         {
-            double f = ret * (double)BASE + value[i];
-
-            if (f > LONG_MAX)
+            if (ret > (max_int >> BITS))
             {
                 throw std::invalid_argument("Overflow");
             }
 
-            ret = ret * BASE + value[i];
+            ret = (ret << BITS) | value[i];
         }
 
-        return ret;
+        if (ret > max_int)
+        {
+            throw std::invalid_argument("Overflow");
+        }
+
+        return (__int64) ret;
     }
     //=========================================================================================================
     // Monitoring and Testing
     //=========================================================================================================
     inline std::string ToString() const
     {
-        if (length == 0)
+        if (IsZero())
         {
             return "0";
         }
 
+        LimbBuffer<2 * N> digits(2 * length);
+        auto num_digits = ToDecimal(digits);
+
         std::stringstream ret;
 
-        ret << value[length - 1] << std::setfill('0');
+        ret << digits[num_digits - 1] << std::setfill('0');
 
-        for (auto i = length - 2; i >= 0; --i)
+        for (auto i = num_digits - 2; i >= 0; --i)
         {
-            ret << std::setw(DIGITS) << value[i];
+            ret << std::setw(DIGITS) << digits[i];
         }
         return ret.str();
     }
     //------------------------------------------------------------------------------------------------------
-    inline friend std::ostream& operator << (std::ostream& os, const VLUInt& vli)
+    // Parse a string of decimal digits
+    inline static VLUIntN FromString(const std::string& text)
+    {
+        if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+        {
+            throw std::invalid_argument("Not a number: " + text);
+        }
+
+        VLUIntN ret(0);
+
+        for (auto ch : text)
+        {
+            ret = ret * 10 + (__int64)(ch - '0');
+        }
+        return ret;
+    }
+    //------------------------------------------------------------------------------------------------------
+    // Binary form for checkpoints, the length then the limbs, least significant first, in the
+    // machine's byte order
+    inline void Save(std::ostream& os) const
+    {
+        int32_t len = length;
+
+        os.write((const char*)&len, sizeof(len));
+        os.write((const char*)(const Limb*)value, length * sizeof(Limb));
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline static VLUIntN Load(std::istream& is)
+    {
+        int32_t len = -1;
+
+        is.read((char*)&len, sizeof(len));
+
+        if (! is || len < 0)
+        {
+            throw std::invalid_argument("Bad VLUInt in checkpoint");
+        }
+
+        VLUIntN ret;
+
+        ret.value.Reserve(len);
+        ret.length = len;
+        is.read((char*)(Limb*)ret.value, len * sizeof(Limb));
+
+        if (! is)
+        {
+            throw std::invalid_argument("Bad VLUInt in checkpoint");
+        }
+
+        ret.Trim();
+        return ret;
+    }
+    //------------------------------------------------------------------------------------------------------
+    inline friend std::ostream& operator << (std::ostream& os, const VLUIntN& vli)
     {
         return os << vli.ToString();
     }
@@ -754,7 +1520,7 @@ public:
         for (auto i = 0; i < 3; ++i)
         {
             __int64 x = start[i];
-            auto vlx = VLUInt (start[i]);
+            auto vlx = VLUIntN (start[i]);
 
             if (vlx.ToInt() != x)
             {
@@ -762,7 +1528,7 @@ public:
 
                 sstrm << "Initialise vlx " << start[i] << " returned " << vlx;
 
-                throw std::exception(sstrm.str().c_str());
+                throw std::runtime_error(sstrm.str().c_str());
             }
 
             for (auto j = 0; j < 8; ++j)
@@ -777,13 +1543,13 @@ public:
 
                     sstrm << "Add: " << was << " + " << to_add[j] << ", got " << vlx << ", expected " << x;
 
-                    throw std::exception(sstrm.str().c_str());
+                    throw std::runtime_error(sstrm.str().c_str());
                 }
             }
         }
         // Simple division
 
-        auto result = VLUInt(1000000) / VLUInt(7);
+        auto result = VLUIntN(1000000) / VLUIntN(7);
 
         if (result.ToInt () != 1000000/7)
         {
@@ -791,16 +1557,16 @@ public:
 
             sstrm << "Div: 1000000/7 = " << (1000000 / 7) << ", got " << result << std::endl;
 
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         // Factorials (multiply by int)
 
         std::string f40 = "815915283247897734345611269596115894272000000000";
 
-        static VLUInt fn[41];
+        static VLUIntN fn[41];
 
-        fn[0] = VLUInt(1);
+        fn[0] = VLUIntN(1);
 
         for (int i = 1; i <= 40; ++i)
         {
@@ -813,22 +1579,22 @@ public:
 
             sstrm << "Factorial 40: " << fn[40] << " != 815915283247897734345611269596115894272000000000" << std::endl;
 
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         // Factorials (multiply by VLUInt)
 
-        VLUInt fact (1);
+        VLUIntN fact (1);
 
         for (int i = 1; i <= 40; ++i)
         {
-            fact = fact * VLUInt(i);
+            fact = fact * VLUIntN(i);
 
             if (fact != fn[i])
             {
                 std::stringstream sstrm;
                 sstrm << "Factorial [" << i << "] " << fact << " != " << fn[i];
-                throw std::exception(sstrm.str().c_str());
+                throw std::runtime_error(sstrm.str().c_str());
             }
         }
 
@@ -838,19 +1604,19 @@ public:
         {
             int n = 40 - i;
 
-            fact = fact / VLUInt(n);
+            fact = fact / VLUIntN(n);
 
             if (fact != fn[n - 1])
             {
                 std::stringstream sstrm;
                 sstrm << "Factorial Division [" << i << "] " << fact << " != " << fn[n - 1];
-                throw std::exception(sstrm.str().c_str());
+                throw std::runtime_error(sstrm.str().c_str());
             }
         }
 
         // Cubes, Mod 9, Mod 3 + increment
 
-        auto vli = VLUInt(1000000);
+        auto vli = VLUIntN(1000000);
         static int mod9[3] = { 0, 1, 8 };
 
         for (int i = 0; i < 40; ++i)
@@ -863,7 +1629,7 @@ public:
             {
                 std::stringstream sstrm;
                 sstrm << "Modulo test: " << vli << " cubed = " << c << ", mod 9 = " << m9 << ", mod 3 = " << m3 << std::endl;
-                throw std::exception(sstrm.str().c_str());
+                throw std::runtime_error(sstrm.str().c_str());
             }
 
             ++vli;
@@ -880,12 +1646,12 @@ public:
         {
             std::stringstream sstrm;
             sstrm << "Decrement test: " << vli << " !- " << 1000000 << std::endl;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
         }
 
         // Log 10
 
-        vli = VLUInt(2);
+        vli = VLUIntN(2);
         auto log2 = log10(2.0);
         auto check = (int)((log2 - (int)round(log2)) * 100000000);
 
@@ -900,15 +1666,15 @@ public:
             {
                 std::stringstream sstrm;
                 sstrm << "Power test: " << "Log (" << vli << ") = " << l2 << ": expected " << ipart << " == " << i << " and " << ifpart << " == " << check << std::endl;
-                throw std::exception(sstrm.str().c_str());
+                throw std::runtime_error(sstrm.str().c_str());
             }
             vli = vli * 10;
         }
 
         // Ratio & Pow, should give 1.099511627776
 
-        VLUInt two (2);
-        VLUInt ten (10);
+        VLUIntN two (2);
+        VLUIntN ten (10);
         auto rcheck = 99511627776L;
 
         ten = ten.Pow(12);
@@ -921,13 +1687,220 @@ public:
         {
             std::stringstream sstrm;
             sstrm << "Ratio test: " << two << " / " << ten << " = " << rat << " (" << rcheck << " != " << rchk2 << ") " << std::endl;
-            throw std::exception(sstrm.str().c_str());
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+
+        // Integer cube roots, exact cubes and their neighbours
+
+        for (int i = 1; i <= 36; ++i)
+        {
+            auto c = fn[i].Cube();
+            auto below = c - 1;
+            auto above = c + i;
+
+            if (c.ICbrt() != fn[i] || below.ICbrt() != fn[i] - 1 || above.ICbrt() != fn[i])
+            {
+                std::stringstream sstrm;
+                sstrm << "Cube root test: " << fn[i] << "^3 = " << c << ", got " << c.ICbrt() << ", " << below.ICbrt() << ", " << above.ICbrt();
+                throw std::runtime_error(sstrm.str().c_str());
+            }
         }
 
+        TestMultiply();
+        TestDivide();
+        TestRoot();
+
         // Finished
 
         std::cout << "VLUInt: All tests passed." << std::endl;
     }
+    //------------------------------------------------------------------------------------------------------
+    // Comba, Karatsuba (if N is wide enough to reach KARATSUBA_LIMBS) and squaring against the
+    // schoolbook product, on random numbers of every length that fits
+    inline static void TestMultiply()
+    {
+        uint64_t seed = 88172645463325252ULL;
+
+        for (int len1 = 1; len1 <= TEST_LEN; ++len1)
+        {
+            for (int len2 = 1; len1 + len2 - 1 < TEST_LEN; ++len2)
+            {
+                auto a = Random(len1, seed);
+                auto b = Random(len2, seed);
+                auto expected = a.MulSchoolbook(b);
+
+                if (a * b != expected || b * a != expected)
+                {
+                    std::stringstream sstrm;
+                    sstrm << "Multiply test: " << len1 << " x " << len2 << " limbs, " << a << " * " << b << " = " << (a * b) << ", expected " << expected;
+                    throw std::runtime_error(sstrm.str().c_str());
+                }
+            }
+
+            if (2 * len1 - 1 < TEST_LEN)
+            {
+                auto a = Random(len1, seed);
+
+                if (a.Square() != a.MulSchoolbook(a))
+                {
+                    std::stringstream sstrm;
+                    sstrm << "Square test: " << len1 << " limbs, " << a << "^2 = " << a.Square() << ", expected " << a.MulSchoolbook(a);
+                    throw std::runtime_error(sstrm.str().c_str());
+                }
+            }
+        }
+
+        // All ones is the worst case for the carries
+
+        VLUIntN ones;
+
+        ones.length = TEST_LEN / 2;
+        ones.value.Reserve(ones.length);
+        ::memset(ones.value, 0xff, ones.length * sizeof(Limb));
+
+        if (ones.Square() != ones.MulSchoolbook(ones) || ones * (ones - 1) != ones.MulSchoolbook(ones - 1))
+        {
+            throw std::runtime_error("Multiply test: all ones");
+        }
+
+        // Overflow, or growing past the inline limbs
+
+        if (GROWS)
+        {
+            auto square = ones.Square();
+
+            if (square.Square() != square.MulSchoolbook(square))
+            {
+                throw std::runtime_error("Multiply test: growing");
+            }
+            return;
+        }
+
+        try
+        {
+            ones.Square().Square();
+            throw std::runtime_error("Multiply test: no overflow");
+        }
+        catch (std::overflow_error&)
+        {
+        }
+    }
+    //------------------------------------------------------------------------------------------------------
+    // Knuth division on every pair of lengths, checks u = qv + r with r < v. Half the numbers are
+    // made from 0, 1 and the limbs either side of the top bit, which is where the quotient guesses
+    // go wrong and have to be put back.
+    inline static void TestDivide()
+    {
+        static const Limb edges[] = { 0, 1, 0x7fffffff, 0x80000000, 0xfffffffe, 0xffffffff };
+        uint64_t seed = 0x2545F4914F6CDD1DULL;
+
+        for (int len1 = 1; len1 <= TEST_LEN; ++len1)
+        {
+            for (int len2 = 1; len2 <= len1; ++len2)
+            {
+                for (int pass = 0; pass < 4; ++pass)
+                {
+                    auto u = Random(len1, seed);
+                    auto v = Random(len2, seed);
+
+                    if (pass % 2 == 1)
+                    {
+                        for (int i = 0; i < len1; ++i) u.value[i] = edges[(seed >> (i % 60)) % 6];
+                        for (int i = 0; i < len2; ++i) v.value[i] = edges[(seed >> (i % 50 + 3)) % 6];
+
+                        u.Trim();
+                        v.Trim();
+
+                        if (v.IsZero()) v = VLUIntN(1);
+                    }
+
+                    auto dm = u.DivMod(v);
+
+                    if (dm.first.MulSchoolbook(v) + dm.second != u || dm.second >= v || dm.first != u / v || dm.second != u % v)
+                    {
+                        std::stringstream sstrm;
+                        sstrm << "Divide test: " << u << " / " << v << " = " << dm.first << " remainder " << dm.second;
+                        throw std::runtime_error(sstrm.str().c_str());
+                    }
+                }
+            }
+        }
+
+        try
+        {
+            VLUIntN(5) / VLUIntN(0);
+            throw std::runtime_error("Divide test: no divide by zero");
+        }
+        catch (std::invalid_argument&)
+        {
+        }
+    }
+    //------------------------------------------------------------------------------------------------------
+    // Roots of random numbers of every length, root^n <= this < (root + 1)^n and the remainder
+    // makes up the difference
+    inline static void TestRoot()
+    {
+        uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+        for (int len = 1; len <= TEST_LEN; ++len)
+        {
+            auto a = Random(len, seed);
+
+            for (int n : { 2, 3, 4, 5, 7, 40 })
+            {
+                auto rr = a.IRootRem(n);
+                VLUIntN<2 * N> power = VLUIntN<2 * N>(rr.first).Pow(n);
+                VLUIntN<2 * N> above = VLUIntN<2 * N>(rr.first + 1).Pow(n);
+
+                if (power + VLUIntN<2 * N>(rr.second) != VLUIntN<2 * N>(a) || !(above > VLUIntN<2 * N>(a)))
+                {
+                    std::stringstream sstrm;
+                    sstrm << "Root test: " << n << "th root of " << a << " = " << rr.first << " remainder " << rr.second;
+                    throw std::runtime_error(sstrm.str().c_str());
+                }
+            }
+
+            if (a.IRoot(TEST_LEN * BITS) != 1 || a.IRootRem(TEST_LEN * BITS).second != a - 1)
+            {
+                throw std::runtime_error("Root test: root higher than the bit length");
+            }
+        }
+
+        // Exact cubes and either side of them
+
+        auto c = Random(TEST_LEN / 3, seed);
+        auto c3 = c.Cube();
+
+        if (c3.ICbrt() != c || (c3 - 1).ICbrt() != c - 1 || (c3 + 1).ICbrtRem().second != 1)
+        {
+            std::stringstream sstrm;
+            sstrm << "Cube root test: " << c << "^3 = " << c3 << ", got " << c3.ICbrt();
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+    }
+    //------------------------------------------------------------------------------------------------------
+    // A random number with exactly len limbs (xorshift, so the tests always see the same numbers)
+    inline static VLUIntN Random(int len, uint64_t& seed)
+    {
+        VLUIntN ret;
+
+        ret.value.Reserve(len);
+
+        for (int i = 0; i < len; ++i)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            ret.value[i] = (Limb) seed;
+        }
+
+        ret.value[len - 1] |= 1;
+        ret.length = len;
+
+        return ret;
+    }
 
 };
 
+
+typedef VLUIntN<0> VLUInt;      // No limit
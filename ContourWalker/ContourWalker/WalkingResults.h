@@ -1,23 +1,31 @@
 #pragma once
 
-#include <map>
-#include <list>
+#include <sstream>
+#include <vector>
 
 #include "VLInt.h"
+#include "Checkpoint.h"
 #include "Result.h"
+#include "ResultIndex.h"
 
 //-------------------------------------------------------------------------------------------------
 // Cube sum searcher results
 //
+// Repeats are dropped using the index. A walk that prints its results has them in results.txt
+// too, so the results themselves are only kept when asked (SetKeep), by the owner of a quiet
+// walk, which Takes them as it goes.
+//
 // (c) John Whitehouse 2021
 // www.eddaardvark.co.uk
 //-------------------------------------------------------------------------------------------------
 
 class WalkingResults
 {
-    std::map<std::string, Result> values;
-    std::map<__int64, std::list<std::string>> results;
+    ResultIndex seen;
+    std::vector<Result> found;      // New results since the last Take in the order found, if kept
     __int64 count;
+    bool quiet{ false };
+    bool keep{ false };
 
 public:
 
@@ -26,29 +34,95 @@ public:
     {
     }
     //-------------------------------------------------------------------------------------------------
-    inline void Add(const Result& result)
+    // Returns false if the result was already known
+    inline bool Add(const Result& result)
     {
         result.VerifySolution();
 
+        return Record(result);
+    }
+    //-------------------------------------------------------------------------------------------------
+    // Add for a result that has already been verified (see ResultPipeline)
+    inline bool Record(const Result& result)
+    {
+        Trace::Span span("WalkingResults::Record");
+
         ++count;
 
-        auto key = result.Key();
+        if (! seen.Insert(result.Print()))
+        {
+            return false;
+        }
 
-        if (values.find(key) != values.end())
+        if (keep)
         {
-            return;
+            found.emplace_back(result);
         }
 
-        values.emplace (key, result);
+        if (! quiet)
+        {
+            // Printed from the recorder thread while the walker prints its chunks, so each line
+            // goes out in one write
 
-        results[result.value].emplace_back(key);
+            std::stringstream sstrm;
 
-        std::cout << "Result " << count << ": " << result << std::endl;
+            sstrm << "Result " << count << ": " << result << "\n";
+            std::cout << sstrm.str() << std::flush;
+        }
+        return true;
+    }
+    //-------------------------------------------------------------------------------------------------
+    // Adds the results from another walk in the order that it found them, they were verified
+    // when it added them
+    inline void Merge(const WalkingResults& other)
+    {
+        for (auto& result : other.found)
+        {
+            Record(result);
+        }
+    }
+    //-------------------------------------------------------------------------------------------------
+    // The results kept since the last call
+    inline std::vector<Result> Take()
+    {
+        std::vector<Result> taken;
+
+        taken.swap(found);
+        return taken;
+    }
+    //-------------------------------------------------------------------------------------------------
+    // Only the count is saved. A resumed walk starts with an empty index, as if it had just been
+    // reset, so a repeat of a result from just before the checkpoint is written again.
+    inline void Save(std::ostream& os) const
+    {
+        Checkpoint::Write(os, count);
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline void Load(std::istream& is)
+    {
+        count = Checkpoint::Read<__int64>(is);
+    }
+    //-------------------------------------------------------------------------------------------------
+    // The index and the results kept
+    inline size_t Bytes() const
+    {
+        return seen.Bytes() + found.capacity() * sizeof(Result);
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline const std::vector<Result>& Found() const { return found; }
+    inline const ResultIndex& Index() const { return seen; }
+    inline void SetQuiet(bool q) { quiet = q; }
+    inline void SetKeep(bool k) { keep = k; }
+    //-------------------------------------------------------------------------------------------------
+    inline friend std::ostream& operator << (std::ostream& os, const WalkingResults& results)
+    {
+        os << results.seen;
 
-        while (results[result.value].size () > 10)
+        if (! results.found.empty())
         {
-            results[result.value].erase(results[result.value].begin());
+            os << ", " << results.found.size() << " kept, " << (results.Bytes() + 1023) / 1024 << " KB in all";
         }
+        return os;
     }
 };
 
@@ -0,0 +1 @@
+#include "WorkPool.h"
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+#include "Platform.h"
+
+//-------------------------------------------------------------------------------------------------
+// A work stealing thread pool. Each worker has its own queue, it takes the newest task from its
+// own queue and, when that is empty, the oldest task from another worker's queue. Tasks can push
+// more tasks (usually their own continuation) onto the queue of the worker running them.
+//
+// Run returns once every task, including those pushed while running, has finished. The first
+// exception thrown by a task is rethrown from Run. A worker with nothing to do spins briefly, then
+// sleeps until a task is pushed.
+//
+// (c) John Whitehouse 2022
+// www.eddaardvark.co.uk
+//-------------------------------------------------------------------------------------------------
+
+class WorkPool
+{
+public:
+
+    typedef std::function<void(int worker)> Task;
+
+private:
+
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    static const int SPINS = 64;        // Tries for a task before a worker sleeps
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::atomic<__int64> m_pending{ 0 };
+    std::atomic<__int64> m_steals{ 0 };
+    std::atomic<bool> m_failed{ false };
+    std::mutex m_error_lock;
+    std::string m_error;
+
+    // Sleeping workers
+
+    std::mutex m_idle_lock;
+    std::condition_variable m_wake;
+    std::atomic<__int64> m_pushed{ 0 };     // Tasks pushed so far, a sleeper wakes when it changes
+    std::atomic<int> m_idle{ 0 };           // Workers asleep or about to be
+
+public:
+
+    WorkPool(int threads)
+    {
+        for (int i = 0; i < threads; ++i)
+        {
+            m_queues.emplace_back(new Queue());
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    inline int Threads() const
+    {
+        return (int) m_queues.size();
+    }
+    //--------------------------------------------------------------------------------------------
+    inline __int64 Steals() const
+    {
+        return m_steals;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Adds a task to the back of a worker's queue
+    void Push(int worker, Task task)
+    {
+        auto& queue = *m_queues[worker % m_queues.size()];
+
+        ++m_pending;
+
+        {
+            std::lock_guard<std::mutex> guard(queue.lock);
+            queue.tasks.emplace_back(std::move(task));
+        }
+
+        ++m_pushed;
+
+        if (m_idle > 0)
+        {
+            Wake();
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    void Run()
+    {
+        std::vector<std::thread> threads;
+
+        for (int i = 0; i < Threads(); ++i)
+        {
+            threads.emplace_back(&WorkPool::Work, this, i);
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        if (m_failed)
+        {
+            throw std::runtime_error(m_error.c_str());
+        }
+    }
+
+    //=========================================================================================================
+    // Testing
+    //=========================================================================================================
+    // Tasks that push their own continuations all run
+    inline static void Test()
+    {
+        WorkPool pool(4);
+        std::atomic<int> count{ 0 };
+        std::function<void(int, int)> task = [&](int worker, int left)
+        {
+            ++count;
+
+            if (left > 0)
+            {
+                pool.Push(worker, [&task, left](int w) { task(w, left - 1); });
+            }
+        };
+
+        for (int i = 0; i < 100; ++i)
+        {
+            pool.Push(0, [&task](int w) { task(w, 9); });
+        }
+
+        pool.Run();
+
+        if (count != 1000)
+        {
+            std::stringstream sstrm;
+            sstrm << "WorkPool test: ran " << count << " tasks, expected 1000, steals = " << pool.Steals();
+            throw std::runtime_error(sstrm.str().c_str());
+        }
+
+        // Finished
+
+        std::cout << "WorkPool: All tests passed." << std::endl;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------------------------
+    void Work(int worker)
+    {
+        int spins = 0;
+
+        while (! m_failed)
+        {
+            Task task;
+            __int64 pushed = m_pushed;
+
+            if (Pop(worker, task) || Steal(worker, task))
+            {
+                try
+                {
+                    task(worker);
+                }
+                catch (std::exception& ex)
+                {
+                    std::lock_guard<std::mutex> guard(m_error_lock);
+
+                    if (! m_failed)
+                    {
+                        m_error = ex.what();
+                        m_failed = true;
+                    }
+                }
+
+                if (--m_pending == 0 || m_failed)
+                {
+                    Wake();
+                }
+                spins = 0;
+            }
+            else if (m_pending == 0)
+            {
+                return;
+            }
+            else if (++spins < SPINS)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                // Nothing to steal until another task is pushed or the last one finishes
+
+                std::unique_lock<std::mutex> guard(m_idle_lock);
+
+                ++m_idle;
+                m_wake.wait(guard, [this, pushed]() { return m_pushed != pushed || m_pending == 0 || m_failed; });
+                --m_idle;
+                spins = 0;
+            }
+        }
+    }
+    //--------------------------------------------------------------------------------------------
+    // Wakes the sleeping workers, taking the lock so that one about to sleep sees what changed
+    void Wake()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_idle_lock);
+        }
+        m_wake.notify_all();
+    }
+    //--------------------------------------------------------------------------------------------
+    // Newest task from the worker's own queue
+    bool Pop(int worker, Task& task)
+    {
+        auto& queue = *m_queues[worker];
+        std::lock_guard<std::mutex> guard(queue.lock);
+
+        if (queue.tasks.empty())
+        {
+            return false;
+        }
+
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    // Oldest task from the first other worker that has one
+    bool Steal(int thief, Task& task)
+    {
+        for (int i = 1; i < Threads(); ++i)
+        {
+            auto& queue = *m_queues[(thief + i) % Threads()];
+            std::lock_guard<std::mutex> guard(queue.lock);
+
+            if (! queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                ++m_steals;
+                return true;
+            }
+        }
+        return false;
+    }
+};
@@ -2,14 +2,29 @@
 //
 
 #include <iostream>
+#include <chrono>
 
 #include "VLUInt.h"
 #include "VLInt.h"
 #include "BigCube.h"
 #include "SubCube.h"
-#include "CommandLine.h"
+#include "CommandLIne.h"
 #include "ContourWalker.h"
 #include "FourPointCubic.h"
+#include "Int128.h"
+#include "DeltaPoint.h"
+#include "ParallelWalker.h"
+#include "BatchWalker.h"
+#include "ResultWriter.h"
+#include "Checkpoint.h"
+#include "StepBenchmark.h"
+#include "MultiplyBenchmark.h"
+#include "LaneWalker.h"
+#include "CpuDispatch.h"
+#include "ResultIndex.h"
+#include "Metrics.h"
+#include "BenchmarkSuite.h"
+#include "Trace.h"
 
 
 void RunTests()
@@ -19,10 +34,29 @@ void RunTests()
     try
     {
         VLUInt::Test();
+        VLUIntN<96>::TestMultiply();     // Wide enough for Karatsuba
         VLInt::Test();
         BigCube::Test();
         SubCube::Test();
         FourPointCubic::Test();
+        CubicSpotter::Test();
+        ResultIndex::Test();
+        Metrics::Test();
+        Trace::Test();
+        BoundedQueue<int>::Test();
+        SpscQueue<int>::Test();
+        ResultPipeline::Test();
+        DeltaPoint::Test<ContourPoint>(5);
+        DeltaPoint::Test<ContourPoint>(1000003);
+        ContourWalker::Test();
+        LaneWalkerT<VLIntN<4>, ContourPointT>::Test();
+        LaneWalkerT<VLIntN<4>, DeltaPointT>::Test();
+        WorkPool::Test();
+#ifdef __SIZEOF_INT128__
+        Int128::Test();
+        CubicSpotterT<Int128>::Test();
+        DeltaPointT<Int128>::Test<ContourPointT<Int128>>(5);
+#endif
     }
     catch (std::exception & ex)
     {
@@ -32,21 +66,133 @@ void RunTests()
 }
 
 
-void RunCalculation(__int64 contour, __int64 steps, __int64 chunk_size)
+template <class Int, template <class> class Point>
+void SaveCheckpoint(const TieredWalkerT<Int, Point>& walker, const Checkpoint::Settings& settings)
 {
-    std::cout << "Contour = " << contour << std::endl;
-    if (steps == 0)
-        std::cout << "Steps = run forever" << std::endl;
+    // The results file has to be up to date first, it isn't rewritten on resume
+
+    walker.Drain();
+    ResultWriter::FlushAll();
+    Checkpoint::Save(Checkpoint::FileName(), settings, [&walker](std::ostream& os) { walker.Save(os); });
+
+    std::cout << "Checkpoint saved at x = " << walker.X() << std::endl;
+}
+
+
+template <class Int, template <class> class Point>
+void ReportWalk(const TieredWalkerT<Int, Point>& walker)
+{
+    // Results waits for the last of them to be recorded, which may print them
+
+    auto& results = walker.Results();
+    auto& families = walker.Families();
+
+    std::cout << "Results seen: " << results << std::endl;
+    std::cout << "Families: " << families.families << ", natural cubics at " << families.natural << " of " << families.points << " crossings" << std::endl;
+
+    if (families.predicted > 0)
+    {
+        std::cout << "Predicted: " << families.predicted << " family members, " << families.confirmed << " confirmed" << std::endl;
+    }
+}
+
+
+template <class Int, template <class> class Point>
+void WalkContour(const CommandLine & cmd)
+{
+    Checkpoint::Settings settings;
+
+    settings.contour = cmd.Contour();
+    settings.steps = cmd.Iterations();
+    settings.chunk_size = cmd.ChunkSize();
+    settings.end_x = cmd.EndX();
+    settings.delta = cmd.Delta();
+
+    std::unique_ptr<TieredWalkerT<Int, Point>> walker;
+
+    if (cmd.Resume())
+    {
+        std::ifstream file;
+
+        Checkpoint::Open(Checkpoint::FileName(), file);
+        walker.reset(new TieredWalkerT<Int, Point>(file, settings.contour, settings.steps, settings.chunk_size, settings.end_x));
+
+        std::cout << "Resuming at x = " << walker->X() << std::endl;
+    }
     else
-        std::cout << "Steps = " << steps << std::endl;
-    std::cout << "Chunk Size = " << chunk_size << std::endl;
+    {
+        walker.reset(new TieredWalkerT<Int, Point>(settings.contour, cmd.StartX(), settings.steps, settings.chunk_size, settings.end_x));
+    }
+
+    walker->SetPredict(cmd.Predict());
+
+    if (cmd.CheckpointSeconds() == 0)
+    {
+        walker->Walk();
+        ReportWalk(*walker);
+        return;
+    }
+
+    auto interval = std::chrono::seconds(cmd.CheckpointSeconds());
+    auto last_save = std::chrono::steady_clock::now();
+
+    while (walker->Step())
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        if (now - last_save >= interval)
+        {
+            SaveCheckpoint(*walker, settings);
+            last_save = now;
+        }
+    }
+
+    // Finished or interrupted, a resume from here carries on (or does nothing) without repeating
+    // any results
+
+    SaveCheckpoint(*walker, settings);
+    ReportWalk(*walker);
+}
+
+
+template <class Int, template <class> class Point>
+void WalkParallel(const CommandLine & cmd)
+{
+    ParallelWalkerT<Int, Point> walker(cmd.Contour(), cmd.StartX(), cmd.ChunkSize(), cmd.EndX(), cmd.Threads());
+
+    std::cout << "Threads = " << walker.Segments() << std::endl;
+
+    walker.Walk();
+}
+
+
+template <class Int, template <class> class Point>
+void WalkBatch(const CommandLine & cmd)
+{
+    BatchWalkerT<Int, Point> walker(cmd.Contour(), cmd.LastContour(), cmd.StartX(), cmd.Iterations(), cmd.ChunkSize(), cmd.EndX(), cmd.Threads(), cmd.Lanes());
 
-    ContourWalker walker(contour, steps, chunk_size);
+    walker.Walk();
+}
 
+
+template <class Int>
+void RunWalker(const CommandLine & cmd)
+{
     time_t now;
         
     time(&now);
-    walker.Walk();
+    if (cmd.IsBatch() && cmd.Delta())
+        WalkBatch<Int, DeltaPointT>(cmd);
+    else if (cmd.IsBatch())
+        WalkBatch<Int, ContourPointT>(cmd);
+    else if (cmd.Threads() > 1 && cmd.Delta())
+        WalkParallel<Int, DeltaPointT>(cmd);
+    else if (cmd.Threads() > 1)
+        WalkParallel<Int, ContourPointT>(cmd);
+    else if (cmd.Delta())
+        WalkContour<Int, DeltaPointT>(cmd);
+    else
+        WalkContour<Int, ContourPointT>(cmd);
     time_t now2;
     time(&now2);
 
@@ -54,26 +200,119 @@ void RunCalculation(__int64 contour, __int64 steps, __int64 chunk_size)
 }
 
 
+void RunCalculation(const CommandLine & cmd)
+{
+    auto steps = cmd.Iterations();
+    auto end_x = cmd.EndX();
+
+    if (cmd.IsBatch())
+        std::cout << "Contours = " << cmd.Contour() << ".." << cmd.LastContour() << std::endl;
+    else
+        std::cout << "Contour = " << cmd.Contour() << std::endl;
+    if (steps == 0)
+        std::cout << "Steps = run forever" << std::endl;
+    else
+        std::cout << "Steps = " << steps << std::endl;
+    std::cout << "Chunk Size = " << cmd.ChunkSize() << std::endl;
+    if (! cmd.StartX().IsZero())
+        std::cout << "Start X = " << cmd.StartX() << std::endl;
+
+    // Use the narrowest integers that can reach end_x on the largest contour. Walks with no end
+    // go on to VLInt if they get too far for VLIntFixed.
+
+    auto limbs = ContourWalker::RequiredLimbs(cmd.LastContour(), end_x);
+
+    if (limbs > 0)
+    {
+        std::cout << "End X = " << end_x << ", limbs = " << limbs << std::endl;
+    }
+
+    if (limbs > VLIntFixed::BITS / 32)
+        RunWalker<VLInt>(cmd);
+    else if (limbs == 0 || limbs > 8)
+        RunWalker<VLIntFixed>(cmd);
+    else if (limbs > 4)
+        RunWalker<VLIntN<8>>(cmd);
+    else if (limbs > 2)
+        RunWalker<VLIntN<4>>(cmd);
+    else
+        RunWalker<VLIntN<2>>(cmd);
+}
+
+
 int main(int argc, char* argv[])
 {
     try
     {
         CommandLine cmd (argc, argv);
 
+        if (cmd.Resume())
+        {
+            std::ifstream file;
+
+            cmd.ApplyCheckpoint(Checkpoint::Open(Checkpoint::FileName(), file));
+        }
+
         if (cmd.ShowHelp())
         {
             CommandLine::ShowOptions();
             exit(0);
         }
 
+        ResultIndex::SetDefaults(cmd.IndexBytes(), cmd.Bloom());
+
+        if (! cmd.Cpu().empty())
+        {
+            CpuDispatch::Select(cmd.Cpu());
+        }
+
         if (cmd.RunTests())
         {
             RunTests();
         }
-        RunCalculation(cmd.Contour(), cmd.Iterations (), cmd.ChunkSize());
+
+        if (cmd.RunBenchmark())
+        {
+            StepBenchmark::Run();
+            MultiplyBenchmark::Run();
+            exit(0);
+        }
+
+        if (cmd.RunSuite())
+        {
+            exit(BenchmarkSuite::Run(cmd.BenchFile(), cmd.BaselineFile(), cmd.Threshold()) > 0 ? 1 : 0);
+        }
+
+        if (cmd.MetricsSeconds() > 0)
+        {
+            Metrics::Start("metrics.jsonl", cmd.MetricsSeconds());
+        }
+
+        if (! cmd.TraceFile().empty())
+        {
+            Trace::Start();
+        }
+
+        ResultWriter::InstallSignalHandlers();
+        RunCalculation(cmd);
+        Metrics::Stop();
+        ResultWriter::CloseAll();
+
+        if (! cmd.TraceFile().empty())
+        {
+            Trace::Stop(cmd.TraceFile());
+            std::cout << "Trace written to " << cmd.TraceFile() << std::endl;
+        }
+
+        if (ResultWriter::Interrupted())
+        {
+            std::cout << "Interrupted, results written" << std::endl;
+        }
     }
     catch (std::exception& ex)
     {
+        Metrics::Stop();
+        ResultWriter::CloseAll();
         std::cout << ex.what() << std::endl;
         CommandLine::ShowOptions();
         exit(-1);